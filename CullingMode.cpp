@@ -0,0 +1,23 @@
+#include "CullingMode.hpp"
+
+std::optional<CullingMode> parse_culling_mode(std::string_view str) noexcept {
+    for (const auto mode : { CullingMode::None, CullingMode::Cpu, CullingMode::Gpu }) {
+        if (str == to_string(mode)) {
+            return mode;
+        }
+    }
+    return std::nullopt;
+}
+
+const char *to_string(CullingMode mode) noexcept {
+    switch (mode) {
+    case CullingMode::None:
+        return "none";
+    case CullingMode::Cpu:
+        return "cpu";
+    case CullingMode::Gpu:
+        return "gpu";
+    default:
+        return "unknown";
+    }
+}
@@ -0,0 +1,14 @@
+#pragma once
+
+#include <optional>
+#include <string_view>
+
+// Where instances outside the view frustum are rejected
+enum class CullingMode {
+    None, // Every instance is drawn
+    Cpu,  // A bounding volume hierarchy is culled on the CPU and only visible transforms are written
+    Gpu   // A compute shader culls every instance and writes one instanced indirect draw of the visible ones
+};
+
+std::optional<CullingMode> parse_culling_mode(std::string_view str) noexcept;
+const char *to_string(CullingMode mode) noexcept;
@@ -0,0 +1,29 @@
+#include "Environment.hpp"
+
+#include <cstdlib>
+#include <cstring>
+
+long get_env_integer(const char *name, long default_value) noexcept {
+    const auto str = getenv(name);
+    if (!str || !*str) {
+        return default_value;
+    }
+
+    char *end;
+    const auto value = strtol(str, &end, 0);
+    if (*end) {
+        return default_value;
+    }
+
+    return value;
+}
+
+bool get_env_flag(const char *name) noexcept {
+    const auto str = getenv(name);
+    return str && *str && strcmp(str, "0");
+}
+
+std::string_view get_env_string(const char *name) noexcept {
+    const auto str = getenv(name);
+    return str ? std::string_view(str) : std::string_view();
+}
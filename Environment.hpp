@@ -0,0 +1,14 @@
+#pragma once
+
+#include <string_view>
+
+// Runtime settings are read from WAYLAND_EXAMPLE_* environment variables
+
+// Returns default_value if the variable is unset or not an integer
+long get_env_integer(const char *name, long default_value) noexcept;
+
+// Returns true if the variable is set to anything other than "0"
+bool get_env_flag(const char *name) noexcept;
+
+// Returns an empty view if the variable is unset
+std::string_view get_env_string(const char *name) noexcept;
@@ -0,0 +1,117 @@
+#include "EventLoop.hpp"
+
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/timerfd.h>
+#include <unistd.h>
+
+#include <array>
+#include <cerrno>
+#include <stdexcept>
+#include <utility>
+
+static constexpr int BAD_FD = -1;
+static constexpr size_t MAX_EVENTS_PER_WAIT = 16;
+
+static void add_to_epoll(int epoll_fd, int fd, uint32_t events) {
+    epoll_event event {
+        .events = events,
+        .data = { .fd = fd }
+    };
+    if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, fd, &event)) {
+        throw std::runtime_error("epoll_ctl() failed");
+    }
+}
+
+EventLoop::EventLoop()
+    :_epoll_fd(BAD_FD)
+    ,_timer_fd(BAD_FD)
+    ,_wake_fd(BAD_FD)
+{
+    _epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    _timer_fd = timerfd_create(CLOCK_MONOTONIC, TFD_CLOEXEC | TFD_NONBLOCK);
+    _wake_fd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    if (_epoll_fd < 0 || _timer_fd < 0 || _wake_fd < 0) {
+        close_fds();
+        throw std::runtime_error("Unable to create event loop");
+    }
+
+    add_to_epoll(_epoll_fd, _timer_fd, EPOLLIN);
+    add_to_epoll(_epoll_fd, _wake_fd, EPOLLIN);
+}
+
+EventLoop::~EventLoop() {
+    close_fds();
+}
+
+void EventLoop::add_fd(int fd, uint32_t events, FdCallback callback) {
+    add_to_epoll(_epoll_fd, fd, events);
+    _callbacks.insert_or_assign(fd, std::move(callback));
+}
+
+void EventLoop::remove_fd(int fd) noexcept {
+    epoll_ctl(_epoll_fd, EPOLL_CTL_DEL, fd, nullptr);
+    _callbacks.erase(fd);
+}
+
+void EventLoop::set_timer(std::chrono::steady_clock::time_point deadline, TimerCallback callback) {
+    // steady_clock is CLOCK_MONOTONIC on linux, so the deadline can be used as an absolute timerfd time
+    const auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(deadline.time_since_epoch()).count();
+    const itimerspec spec {
+        .it_interval = {},
+        .it_value = {
+            .tv_sec = static_cast<time_t>(ns / 1'000'000'000),
+            .tv_nsec = static_cast<long>(ns % 1'000'000'000)
+        }
+    };
+    if (timerfd_settime(_timer_fd, TFD_TIMER_ABSTIME, &spec, nullptr)) {
+        throw std::runtime_error("timerfd_settime() failed");
+    }
+    _timer_callback = std::move(callback);
+}
+
+void EventLoop::cancel_timer() noexcept {
+    const itimerspec spec {};
+    timerfd_settime(_timer_fd, 0, &spec, nullptr);
+    _timer_callback = nullptr;
+}
+
+void EventLoop::wake() noexcept {
+    const uint64_t value = 1;
+    [[maybe_unused]] const auto written = write(_wake_fd, &value, sizeof(value));
+}
+
+void EventLoop::close_fds() noexcept {
+    for (auto *fd : { &_wake_fd, &_timer_fd, &_epoll_fd }) {
+        if (*fd >= 0) {
+            close(*fd);
+        }
+        *fd = BAD_FD;
+    }
+}
+
+void EventLoop::wait(bool block) {
+    std::array<epoll_event, MAX_EVENTS_PER_WAIT> events;
+    const auto num_events = epoll_wait(_epoll_fd, events.data(), events.size(), block ? -1 : 0);
+    if (num_events < 0) {
+        if (EINTR == errno) {
+            return;
+        }
+        throw std::runtime_error("epoll_wait() failed");
+    }
+
+    for (int i = 0; i < num_events; ++i) {
+        const auto fd = events[i].data.fd;
+        uint64_t value;
+
+        if (fd == _wake_fd) {
+            while (read(_wake_fd, &value, sizeof(value)) > 0);
+        } else if (fd == _timer_fd) {
+            if (read(_timer_fd, &value, sizeof(value)) > 0 && _timer_callback) {
+                std::exchange(_timer_callback, nullptr)();
+            }
+        } else if (const auto p = _callbacks.find(fd); p != _callbacks.end()) {
+            p->second(events[i].events);
+        }
+    }
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <unordered_map>
+
+class EventLoop {
+public:
+    using FdCallback = std::function<void(uint32_t events)>;
+    using TimerCallback = std::function<void()>;
+
+    EventLoop();
+    EventLoop(const EventLoop&) = delete;
+    EventLoop(EventLoop&&) noexcept = delete;
+    ~EventLoop();
+
+    EventLoop& operator=(const EventLoop&) = delete;
+    EventLoop& operator=(EventLoop&&) noexcept = delete;
+
+    void add_fd(int fd, uint32_t events, FdCallback callback);
+    void remove_fd(int fd) noexcept;
+
+    // One-shot timer, replaces any previously set deadline
+    void set_timer(std::chrono::steady_clock::time_point deadline, TimerCallback callback);
+    void cancel_timer() noexcept;
+
+    // Interrupts a blocking wait(), safe to call from any thread
+    void wake() noexcept;
+
+    // Dispatches every ready source, sleeping until at least one is ready if block is set
+    void wait(bool block);
+
+private:
+    void close_fds() noexcept;
+
+private:
+    int _epoll_fd;
+    int _timer_fd;
+    int _wake_fd;
+
+    std::unordered_map<int, FdCallback> _callbacks;
+    TimerCallback _timer_callback;
+};
@@ -0,0 +1,160 @@
+#include "JobSystem.hpp"
+
+#include <optional>
+#include <utility>
+
+// Workers record which job system they belong to, any other thread submits to the owner's queue
+static thread_local const JobSystem *t_job_system = nullptr;
+static thread_local size_t t_thread_index = 0;
+
+JobCounter::JobCounter()
+    :_remaining(0)
+{}
+
+bool JobCounter::done() const noexcept {
+    return !_remaining.load(std::memory_order_acquire);
+}
+
+JobSystem::JobSystem(size_t num_workers)
+    :_num_queued(0)
+    ,_stopping(false)
+{
+    for (size_t i = 0; i < num_workers + 1; ++i) {
+        _queues.push_back(std::make_unique<Queue>());
+    }
+
+    try {
+        for (size_t i = 1; i < num_workers + 1; ++i) {
+            _threads.emplace_back(&JobSystem::thread_entry, this, i);
+        }
+    } catch (...) {
+        stop();
+        throw;
+    }
+}
+
+JobSystem::~JobSystem() {
+    stop();
+}
+
+void JobSystem::stop() noexcept {
+    {
+        const auto lock = std::unique_lock{ _sleep_mutex };
+        _stopping = true;
+    }
+    _sleep_cv.notify_all();
+
+    for (auto& thread : _threads) {
+        thread.join();
+    }
+    _threads.clear();
+}
+
+size_t JobSystem::num_threads() const noexcept {
+    return _queues.size();
+}
+
+size_t JobSystem::thread_index() const noexcept {
+    return this == t_job_system ? t_thread_index : 0;
+}
+
+void JobSystem::submit(Job job, JobCounter& counter) {
+    counter._remaining.fetch_add(1, std::memory_order_relaxed);
+
+    auto& queue = *_queues[thread_index()];
+    {
+        const auto lock = std::unique_lock{ queue.mutex };
+        queue.jobs.push_back({ std::move(job), &counter });
+    }
+    _num_queued.fetch_add(1, std::memory_order_release);
+
+    // Sleepers check _num_queued under the mutex, taking it here means none of them can miss the job
+    {
+        const auto lock = std::unique_lock{ _sleep_mutex };
+    }
+    _sleep_cv.notify_one();
+}
+
+void JobSystem::wait(JobCounter& counter) {
+    const auto index = thread_index();
+    while (!counter.done()) {
+        if (try_run_job(index)) {
+            continue;
+        }
+
+        auto lock = std::unique_lock{ _sleep_mutex };
+        _sleep_cv.wait(lock, [&]() {
+            return counter.done() || _num_queued.load(std::memory_order_acquire);
+        });
+    }
+
+    const auto lock = std::unique_lock{ _sleep_mutex };
+    if (counter._error) {
+        std::rethrow_exception(std::exchange(counter._error, nullptr));
+    }
+}
+
+bool JobSystem::try_run_job(size_t thread_index) {
+    std::optional<QueuedJob> queued;
+
+    // Newest of our own jobs first, as its data is most likely still in cache, then the oldest of everyone else's
+    for (size_t i = 0; i < _queues.size() && !queued; ++i) {
+        auto& queue = *_queues[(thread_index + i) % _queues.size()];
+        const auto lock = std::unique_lock{ queue.mutex };
+        if (queue.jobs.empty()) {
+            continue;
+        }
+        if (!i) {
+            queued.emplace(std::move(queue.jobs.back()));
+            queue.jobs.pop_back();
+        } else {
+            queued.emplace(std::move(queue.jobs.front()));
+            queue.jobs.pop_front();
+        }
+    }
+    if (!queued) {
+        return false;
+    }
+    _num_queued.fetch_sub(1, std::memory_order_relaxed);
+
+    std::exception_ptr error;
+    try {
+        queued->job();
+    } catch (...) {
+        error = std::current_exception();
+    }
+
+    auto& counter = *queued->counter;
+    if (error) {
+        const auto lock = std::unique_lock{ _sleep_mutex };
+        if (!counter._error) {
+            counter._error = error;
+        }
+    }
+    if (1 == counter._remaining.fetch_sub(1, std::memory_order_acq_rel)) {
+        {
+            const auto lock = std::unique_lock{ _sleep_mutex };
+        }
+        _sleep_cv.notify_all();
+    }
+    return true;
+}
+
+void JobSystem::thread_entry(size_t thread_index) noexcept {
+    t_job_system = this;
+    t_thread_index = thread_index;
+
+    while (true) {
+        if (try_run_job(thread_index)) {
+            continue;
+        }
+
+        auto lock = std::unique_lock{ _sleep_mutex };
+        _sleep_cv.wait(lock, [this]() {
+            return _stopping || _num_queued.load(std::memory_order_acquire);
+        });
+        if (_stopping) {
+            return;
+        }
+    }
+}
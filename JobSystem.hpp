@@ -0,0 +1,103 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Number of unfinished jobs submitted against it. Waiting on a counter is how jobs depend on
+// each other: a job that needs the results of others waits on their counter before it starts.
+class JobCounter {
+public:
+    JobCounter();
+    JobCounter(const JobCounter&) = delete;
+    JobCounter(JobCounter&&) noexcept = delete;
+    ~JobCounter() = default;
+
+    JobCounter& operator=(const JobCounter&) = delete;
+    JobCounter& operator=(JobCounter&&) noexcept = delete;
+
+    bool done() const noexcept;
+
+private:
+    friend class JobSystem;
+
+    std::atomic<uint32_t> _remaining;
+    // First exception thrown by one of the jobs, guarded by the job system's sleep mutex
+    std::exception_ptr _error;
+};
+
+// Work-stealing scheduler on a fixed pool of threads. Every thread, including the one that owns
+// the job system, has its own deque: jobs are pushed and popped at the back by the thread that
+// submitted them, and idle threads steal from the front of the others.
+class JobSystem {
+public:
+    using Job = std::function<void()>;
+
+    explicit JobSystem(size_t num_workers);
+    JobSystem(const JobSystem&) = delete;
+    JobSystem(JobSystem&&) noexcept = delete;
+    ~JobSystem();
+
+    JobSystem& operator=(const JobSystem&) = delete;
+    JobSystem& operator=(JobSystem&&) noexcept = delete;
+
+    // Worker threads plus the owning thread, which runs jobs while it waits
+    size_t num_threads() const noexcept;
+
+    // Increments the counter, which is decremented again once the job has run
+    void submit(Job job, JobCounter& counter);
+    // Runs queued jobs until the counter reaches zero, then rethrows the first exception one of its jobs threw
+    void wait(JobCounter& counter);
+
+    // Calls fn(begin, end) on ranges covering [0, count) in parallel and blocks until all have run.
+    // Ranges hold at least grain_size items, so cheap items are not drowned in scheduling overhead.
+    template<typename F>
+    void parallel_for(uint32_t count, uint32_t grain_size, F&& fn) {
+        const auto num_ranges = std::clamp<uint32_t>(count / std::max(grain_size, 1u), 1, static_cast<uint32_t>(num_threads() * RANGES_PER_THREAD));
+        const auto range_size = (count + num_ranges - 1) / num_ranges;
+
+        JobCounter counter;
+        for (uint32_t begin = 0; begin < count; begin += range_size) {
+            const auto end = std::min(count, begin + range_size);
+            submit([&fn, begin, end]() { fn(begin, end); }, counter);
+        }
+        wait(counter);
+    }
+
+private:
+    // More ranges than threads lets stealing even out ranges that take longer than others
+    static constexpr size_t RANGES_PER_THREAD = 4;
+
+    struct QueuedJob {
+        Job job;
+        JobCounter *counter;
+    };
+
+    struct Queue {
+        std::mutex mutex;
+        std::deque<QueuedJob> jobs;
+    };
+
+    void stop() noexcept;
+    size_t thread_index() const noexcept;
+    bool try_run_job(size_t thread_index);
+    void thread_entry(size_t thread_index) noexcept;
+
+private:
+    // One per thread, the owning thread's is first
+    std::vector<std::unique_ptr<Queue>> _queues;
+    std::vector<std::thread> _threads;
+
+    std::atomic<size_t> _num_queued;
+    std::mutex _sleep_mutex;
+    std::condition_variable _sleep_cv;
+    bool _stopping;
+};
@@ -0,0 +1,35 @@
+#include "PresentPolicy.hpp"
+
+PresentPolicy next_present_policy(PresentPolicy policy) noexcept {
+    switch (policy) {
+    case PresentPolicy::PowerSaving:
+        return PresentPolicy::LowLatency;
+    case PresentPolicy::LowLatency:
+        return PresentPolicy::TearAllowed;
+    case PresentPolicy::TearAllowed:
+    default:
+        return PresentPolicy::PowerSaving;
+    }
+}
+
+std::optional<PresentPolicy> parse_present_policy(std::string_view str) noexcept {
+    for (const auto policy : { PresentPolicy::PowerSaving, PresentPolicy::LowLatency, PresentPolicy::TearAllowed }) {
+        if (str == to_string(policy)) {
+            return policy;
+        }
+    }
+    return std::nullopt;
+}
+
+const char *to_string(PresentPolicy policy) noexcept {
+    switch (policy) {
+    case PresentPolicy::PowerSaving:
+        return "power-saving";
+    case PresentPolicy::LowLatency:
+        return "low-latency";
+    case PresentPolicy::TearAllowed:
+        return "tear-allowed";
+    default:
+        return "unknown";
+    }
+}
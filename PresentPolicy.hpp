@@ -0,0 +1,15 @@
+#pragma once
+
+#include <optional>
+#include <string_view>
+
+// Trade-off the swapchain should make when choosing a present mode
+enum class PresentPolicy {
+    PowerSaving, // Strict vsync, the CPU and GPU sleep while waiting for the display
+    LowLatency,  // Never blocks on the display and never tears, at the cost of rendering unseen frames
+    TearAllowed  // Shows each frame as soon as it is ready, even mid-scanout
+};
+
+PresentPolicy next_present_policy(PresentPolicy policy) noexcept;
+std::optional<PresentPolicy> parse_present_policy(std::string_view str) noexcept;
+const char *to_string(PresentPolicy policy) noexcept;
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <type_traits>
+
+// Lock-free ring buffer with a single producer thread and a single consumer thread. Each side
+// owns one index and only reads the other's when its cached copy says the ring is full or empty,
+// so in the steady state producer and consumer do not share a cache line.
+template<typename T, size_t Capacity>
+class SpscQueue {
+    static_assert(std::has_single_bit(Capacity), "Capacity must be a power of two");
+    static_assert(std::is_nothrow_copy_assignable_v<T> && std::is_nothrow_default_constructible_v<T>);
+
+public:
+    SpscQueue()
+        :_head(0)
+        ,_cached_tail(0)
+        ,_tail(0)
+        ,_cached_head(0)
+    {}
+    SpscQueue(const SpscQueue&) = delete;
+    SpscQueue(SpscQueue&&) noexcept = delete;
+    ~SpscQueue() = default;
+
+    SpscQueue& operator=(const SpscQueue&) = delete;
+    SpscQueue& operator=(SpscQueue&&) noexcept = delete;
+
+    static constexpr size_t capacity() noexcept {
+        return Capacity;
+    }
+
+    // Producer only, returns false if the ring is full
+    bool try_push(const T& item) noexcept {
+        return try_push_all(1, [&](size_t) -> const T& { return item; });
+    }
+
+    // Producer only, pushes make_item(0) to make_item(count - 1) or, if the ring lacks room for all
+    // of them, nothing. The consumer sees every item at once.
+    template<typename F>
+    bool try_push_all(size_t count, F&& make_item) noexcept {
+        const auto tail = _tail.load(std::memory_order_relaxed);
+        if (tail - _cached_head + count > Capacity) {
+            _cached_head = _head.load(std::memory_order_acquire);
+            if (tail - _cached_head + count > Capacity) {
+                return false;
+            }
+        }
+
+        for (size_t i = 0; i < count; ++i) {
+            _items[(tail + i) & (Capacity - 1)] = make_item(i);
+        }
+        _tail.store(tail + count, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer only, returns false if the ring is empty
+    bool try_pop(T& item) noexcept {
+        const auto head = _head.load(std::memory_order_relaxed);
+        if (head == _cached_tail) {
+            _cached_tail = _tail.load(std::memory_order_acquire);
+            if (head == _cached_tail) {
+                return false;
+            }
+        }
+
+        item = _items[head & (Capacity - 1)];
+        _head.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+private:
+    // Avoids std::hardware_destructive_interference_size, which is not stable across compiler flags
+    static constexpr size_t CACHE_LINE_SIZE = 64;
+
+    // Consumer side
+    alignas(CACHE_LINE_SIZE) std::atomic<size_t> _head;
+    size_t _cached_tail;
+    // Producer side
+    alignas(CACHE_LINE_SIZE) std::atomic<size_t> _tail;
+    size_t _cached_head;
+
+    alignas(CACHE_LINE_SIZE) std::array<T, Capacity> _items;
+};
@@ -1,14 +1,104 @@
+#include "Environment.hpp"
+#include "EventLoop.hpp"
 #include "vulkan/Renderer.hpp"
 #include "wayland/Display.hpp"
 #include "wayland/Window.hpp"
 
+#include <cstdio>
+
 int main() {
+    // Outlives the display, whose event threads wake it
+    EventLoop loop;
     Display display;
     Window window(display);
     Renderer renderer(window);
 
+    display.attach(loop);
+
+    window.set_continuous_rendering(get_env_flag("WAYLAND_EXAMPLE_CONTINUOUS"));
+
     while (!window.should_close()) {
-        display.poll_events();
-        renderer.render();
+        display.prepare_read();
+        // Events dispatched while preparing to read would otherwise wait out the sleep
+        window.update();
+        loop.wait(!window.frame_due());
+        display.read_events();
+        window.update();
+
+        if (window.frame_due()) {
+            renderer.render();
+        }
+    }
+    display.detach();
+
+    std::printf("Rendered %llu frames with %zu frames in flight\n",
+        static_cast<unsigned long long>(renderer.submitted_frames()), renderer.frames_in_flight());
+
+    const auto frame_allocator = renderer.frame_allocator_statistics();
+    std::printf("Frame allocator: %llu of %llu bytes per frame used at most, %u overflows\n",
+        static_cast<unsigned long long>(frame_allocator.high_water_mark),
+        static_cast<unsigned long long>(frame_allocator.frame_capacity), frame_allocator.num_overflows);
+
+    const auto recording = renderer.recording_statistics();
+    if (recording.num_frames) {
+        std::printf("Recording %u draws into %zu secondary command buffers on %zu threads over %u frames: avg %.3fms, max %.3fms\n",
+            recording.draw_count, recording.num_slices, recording.num_threads, recording.num_frames, recording.average_ms, recording.max_ms);
+    }
+
+    const auto transforms = renderer.transform_statistics();
+    if (transforms.num_frames) {
+        std::printf("Transforms for %u instances with the %s kernel on %zu threads over %u frames: avg %.3fms, max %.3fms\n",
+            transforms.num_instances, to_string(transforms.kernel), transforms.num_threads, transforms.num_frames, transforms.average_ms, transforms.max_ms);
+    }
+
+    const auto culling = renderer.culling_statistics();
+    if (culling.num_frames) {
+        std::printf("CPU culling of %u instances in %zu nodes over %u frames: %.3fms, %.0f nodes tested, %.0f culled, %.0f instances tested, %.0f visible per frame\n",
+            culling.num_instances, culling.num_nodes, culling.num_frames, culling.average_ms,
+            culling.nodes_tested, culling.nodes_culled, culling.instances_tested, culling.instances_visible);
+    }
+
+    const auto compute_overlap = renderer.compute_overlap_statistics();
+    if (compute_overlap.num_frames) {
+        std::printf("Async compute over %u frames: compute %.3fms, graphics %.3fms, overlapped %.3fms per frame\n",
+            compute_overlap.num_frames, compute_overlap.compute_ms, compute_overlap.graphics_ms, compute_overlap.overlap_ms);
+    } else if (compute_overlap.num_submitted_frames) {
+        std::printf("Async compute: %llu frames submitted compute work, but the device cannot time it against graphics\n",
+            static_cast<unsigned long long>(compute_overlap.num_submitted_frames));
+    } else {
+        std::printf("Async compute: no compute work submitted, run with WAYLAND_EXAMPLE_CULLING=gpu to measure the overlap\n");
+    }
+
+    // Prefer the compositor's timestamps, present wait times include waking the waiting thread
+    const auto& feedback = window.presentation_feedback();
+    const bool has_feedback_latency = feedback && feedback->num_frames();
+    if (const auto latency = has_feedback_latency ? feedback->latency_statistics() : renderer.present_latency_statistics(); latency.num_frames) {
+        std::printf("Submit to display latency (%s) over the last %u frames: min %.2fms, avg %.2fms, max %.2fms\n",
+            has_feedback_latency ? "wp_presentation" : "present wait", latency.num_frames, latency.min_ms, latency.average_ms, latency.max_ms);
+    }
+
+    const auto input = display.input_statistics();
+    if (input.num_events) {
+        std::printf("Input thread to window over %llu events: avg %.3fms, max %.3fms, %llu dropped\n",
+            static_cast<unsigned long long>(input.num_events), input.average_ms, input.max_ms,
+            static_cast<unsigned long long>(input.num_dropped));
+    }
+
+    const auto frame_times = window.frame_scheduler().statistics();
+    if (frame_times.num_frames) {
+        std::printf("Frame callback interval over the last %u frames: min %.2fms, avg %.2fms, max %.2fms\n",
+            frame_times.num_frames, frame_times.min_ms, frame_times.average_ms, frame_times.max_ms);
+    }
+
+    if (feedback && feedback->num_frames()) {
+        size_t num_zero_copy = 0;
+        for (size_t i = 0; i < feedback->num_frames(); ++i) {
+            num_zero_copy += !!(feedback->frame(i).flags & WP_PRESENTATION_FEEDBACK_KIND_ZERO_COPY);
+        }
+
+        const auto refresh_ns = feedback->refresh_interval_ns();
+        std::printf("Presentation over the last %zu frames: refresh %.2fHz, %zu zero-copy, %u missed vblanks, %u discarded\n",
+            feedback->num_frames(), refresh_ns ? 1e9 / *refresh_ns : 0.0, num_zero_copy,
+            feedback->missed_vblanks(), feedback->num_discarded());
     }
 }
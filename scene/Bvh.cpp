@@ -0,0 +1,140 @@
+#include "Bvh.hpp"
+
+#include <glm/common.hpp>
+#include <glm/geometric.hpp>
+
+#include <algorithm>
+#include <limits>
+#include <numeric>
+
+// Small leaves cull tightly, larger ones keep the tree shallow for big scenes
+static constexpr uint32_t MAX_LEAF_OBJECTS = 8;
+static constexpr uint32_t ALL_PLANES = (1u << 6) - 1;
+
+static void append_visible(std::vector<VisibleRange>& visible, BvhCullCounters& counters, uint32_t first, uint32_t count) {
+    counters.objects_visible += count;
+    if (!visible.empty() && visible.back().first + visible.back().count == first) {
+        visible.back().count += count;
+    } else {
+        visible.push_back({ first, count });
+    }
+}
+
+Bvh::Bvh()
+    :_radius(0.0f)
+{}
+
+std::vector<uint32_t> Bvh::build(const std::vector<glm::vec3>& centres, float radius) {
+    _nodes.clear();
+    _centres = centres;
+    _radius = radius;
+
+    std::vector<uint32_t> order(centres.size());
+    std::iota(order.begin(), order.end(), 0u);
+    if (!order.empty()) {
+        // Every node is a leaf or has two children, and median splits of more than MAX_LEAF_OBJECTS
+        // leave at least 4 objects per leaf, so there are at most (n + 3) / 4 leaves. This only
+        // saves regrowing, build_node() refers to nodes by index and stays correct either way.
+        const auto num_leaves = order.size() > MAX_LEAF_OBJECTS ? (order.size() + 3) / 4 : 1;
+        _nodes.reserve(2 * num_leaves - 1);
+        _nodes.push_back({});
+        build_node(0, 0, static_cast<uint32_t>(order.size()), order);
+    }
+
+    for (size_t i = 0; i < order.size(); ++i) {
+        _centres[i] = centres[order[i]];
+    }
+    return order;
+}
+
+size_t Bvh::num_nodes() const noexcept {
+    return _nodes.size();
+}
+
+void Bvh::build_node(uint32_t node_index, uint32_t begin, uint32_t end, std::vector<uint32_t>& order) {
+    glm::vec3 min(std::numeric_limits<float>::max()), max(std::numeric_limits<float>::lowest());
+    for (uint32_t i = begin; i < end; ++i) {
+        min = glm::min(min, _centres[order[i]]);
+        max = glm::max(max, _centres[order[i]]);
+    }
+
+    _nodes[node_index] = {
+        .min = min - glm::vec3(_radius),
+        .max = max + glm::vec3(_radius),
+        .first_child = 0,
+        .first_object = begin,
+        .num_objects = end - begin
+    };
+    if (end - begin <= MAX_LEAF_OBJECTS) {
+        return;
+    }
+
+    const auto extent = max - min;
+    const auto axis = extent.x >= extent.y && extent.x >= extent.z ? 0 : extent.y >= extent.z ? 1 : 2;
+    const auto middle = begin + (end - begin) / 2;
+    std::nth_element(order.begin() + begin, order.begin() + middle, order.begin() + end, [&](uint32_t a, uint32_t b) {
+        return _centres[a][axis] < _centres[b][axis];
+    });
+
+    const auto first_child = static_cast<uint32_t>(_nodes.size());
+    _nodes[node_index].first_child = first_child;
+    _nodes.push_back({});
+    _nodes.push_back({});
+    build_node(first_child, begin, middle, order);
+    build_node(first_child + 1, middle, end, order);
+}
+
+void Bvh::cull(const Frustum& frustum, std::vector<VisibleRange>& visible, BvhCullCounters& counters) const {
+    if (!_nodes.empty()) {
+        cull_node(0, ALL_PLANES, frustum, visible, counters);
+    }
+}
+
+void Bvh::cull_node(uint32_t node_index, uint32_t plane_mask, const Frustum& frustum, std::vector<VisibleRange>& visible, BvhCullCounters& counters) const {
+    const auto& node = _nodes[node_index];
+    ++counters.nodes_tested;
+
+    const auto centre = 0.5f * (node.min + node.max);
+    const auto half_extent = 0.5f * (node.max - node.min);
+    for (uint32_t i = 0; i < frustum.planes.size(); ++i) {
+        if (!(plane_mask & (1u << i))) {
+            continue;
+        }
+
+        const glm::vec3 normal(frustum.planes[i]);
+        const auto distance = glm::dot(normal, centre) + frustum.planes[i].w;
+        const auto projected_extent = glm::dot(glm::abs(normal), half_extent);
+        if (distance < -projected_extent) {
+            ++counters.nodes_culled;
+            return;
+        }
+        if (distance >= projected_extent) {
+            plane_mask &= ~(1u << i);
+        }
+    }
+
+    if (!plane_mask) {
+        append_visible(visible, counters, node.first_object, node.num_objects);
+        return;
+    }
+
+    if (node.first_child) {
+        cull_node(node.first_child, plane_mask, frustum, visible, counters);
+        cull_node(node.first_child + 1, plane_mask, frustum, visible, counters);
+        return;
+    }
+
+    for (uint32_t object = node.first_object; object < node.first_object + node.num_objects; ++object) {
+        ++counters.objects_tested;
+
+        bool is_visible = true;
+        for (uint32_t i = 0; i < frustum.planes.size() && is_visible; ++i) {
+            if (plane_mask & (1u << i)) {
+                is_visible = glm::dot(glm::vec3(frustum.planes[i]), _centres[object]) + frustum.planes[i].w >= -_radius;
+            }
+        }
+        if (is_visible) {
+            append_visible(visible, counters, object, 1);
+        }
+    }
+}
@@ -0,0 +1,54 @@
+#pragma once
+
+#include "Frustum.hpp"
+
+#include <glm/vec3.hpp>
+
+#include <cstdint>
+#include <vector>
+
+struct BvhNode {
+    glm::vec3 min, max;
+    // Children are stored next to each other, 0 for leaves
+    uint32_t first_child;
+    // Every node covers a contiguous range of objects, in the order returned by build()
+    uint32_t first_object, num_objects;
+};
+
+// Objects [first, first + count) found visible, in BVH order
+struct VisibleRange {
+    uint32_t first, count;
+};
+
+struct BvhCullCounters {
+    uint64_t nodes_tested, nodes_culled;
+    // Objects tested individually in leaves that straddle the frustum
+    uint64_t objects_tested;
+    uint64_t objects_visible;
+};
+
+// Bounding volume hierarchy over bounding spheres, split at the median of the longest axis
+class Bvh {
+public:
+    Bvh();
+
+    // Builds the hierarchy and returns the order objects must be stored in so that every node's
+    // objects are contiguous: element i is the index, in the given arrays, of the i-th object
+    std::vector<uint32_t> build(const std::vector<glm::vec3>& centres, float radius);
+
+    size_t num_nodes() const noexcept;
+
+    // Appends the visible objects as ranges, merging neighbours. Planes a node is entirely inside
+    // of are not tested again below it, and nodes entirely inside the frustum are not descended.
+    void cull(const Frustum& frustum, std::vector<VisibleRange>& visible, BvhCullCounters& counters) const;
+
+private:
+    void build_node(uint32_t node_index, uint32_t begin, uint32_t end, std::vector<uint32_t>& order);
+    void cull_node(uint32_t node_index, uint32_t plane_mask, const Frustum& frustum, std::vector<VisibleRange>& visible, BvhCullCounters& counters) const;
+
+private:
+    std::vector<BvhNode> _nodes;
+    // Copies of the object centres in build order, for testing leaf objects individually
+    std::vector<glm::vec3> _centres;
+    float _radius;
+};
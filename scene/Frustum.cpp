@@ -0,0 +1,22 @@
+#include "Frustum.hpp"
+
+#include <glm/geometric.hpp>
+#include <glm/gtc/matrix_access.hpp>
+
+// Planes bounding -w <= x, y <= w and 0 <= z <= w in clip space. The infinite reversed-z
+// projection leaves one plane without a normal, which every point is in front of.
+Frustum Frustum::from_view_projection(const glm::mat4& view_projection) noexcept {
+    const auto x = glm::row(view_projection, 0);
+    const auto y = glm::row(view_projection, 1);
+    const auto z = glm::row(view_projection, 2);
+    const auto w = glm::row(view_projection, 3);
+
+    Frustum ret { .planes = { w + x, w - x, w + y, w - y, z, w - z } };
+    for (auto& plane : ret.planes) {
+        const auto length = glm::length(glm::vec3(plane));
+        if (length > 0.0f) {
+            plane /= length;
+        }
+    }
+    return ret;
+}
@@ -0,0 +1,15 @@
+#pragma once
+
+#include <glm/mat4x4.hpp>
+#include <glm/vec3.hpp>
+#include <glm/vec4.hpp>
+
+#include <array>
+
+// View frustum as six world space planes, normals pointing inwards and normalized so that
+// distances are in world units
+struct Frustum {
+    std::array<glm::vec4, 6> planes;
+
+    static Frustum from_view_projection(const glm::mat4& view_projection) noexcept;
+};
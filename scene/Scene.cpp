@@ -0,0 +1,135 @@
+#include "Scene.hpp"
+
+#include <glm/gtc/constants.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+static constexpr glm::vec3 ORIGIN { -1.0f, -0.75f, 0.0f };
+static constexpr float INSTANCE_SPACING = 3.0f;
+static constexpr uint32_t NUM_ANGULAR_VELOCITIES = 7;
+static constexpr float ANGULAR_VELOCITY_STEP = 0.25f;
+// Instances per job, enough to amortize scheduling while still splitting 10k instances across a few threads
+static constexpr uint32_t TRANSFORM_GRAIN_SIZE = 2048;
+
+Scene::Scene(uint32_t num_instances, float bounding_radius)
+    :_transforms(std::clamp(num_instances, 1u, MAX_SCENE_INSTANCES))
+    ,_statistics{}
+    ,_culling_statistics{}
+{
+    num_instances = _transforms.size();
+
+    // Centred across the view, extending away from the camera
+    const auto side = static_cast<uint32_t>(std::ceil(std::cbrt(static_cast<double>(num_instances))));
+    const auto centre = static_cast<float>(side - 1) / 2.0f;
+
+    std::vector<glm::vec3> positions;
+    positions.reserve(num_instances);
+    for (uint32_t i = 0; i < num_instances; ++i) {
+        const glm::vec3 cell {
+            static_cast<float>(i % side) - centre,
+            static_cast<float>(i / side % side) - centre,
+            static_cast<float>(i / (side * side))
+        };
+        positions.push_back(ORIGIN + INSTANCE_SPACING * cell);
+    }
+
+    const auto order = _bvh.build(positions, bounding_radius);
+    _phases.reserve(num_instances);
+    _angular_velocities.reserve(num_instances);
+    for (uint32_t i = 0; i < num_instances; ++i) {
+        const auto instance = order[i];
+        _transforms.set_position(i, positions[instance]);
+        _phases.push_back(static_cast<float>(instance) * 0.5f);
+        _angular_velocities.push_back(static_cast<float>(instance % NUM_ANGULAR_VELOCITIES) * ANGULAR_VELOCITY_STEP);
+    }
+
+    _statistics.num_instances = num_instances;
+    _statistics.kernel = TransformStore::best_kernel();
+    _culling_statistics.num_instances = num_instances;
+    _culling_statistics.num_nodes = _bvh.num_nodes();
+}
+
+uint32_t Scene::num_instances() const noexcept {
+    return _transforms.size();
+}
+
+void Scene::write_transforms(double time_s, glm::mat4 *transforms, JobSystem& jobs) {
+    _ranges.clear();
+    for (uint32_t first = 0; first < _transforms.size(); first += TRANSFORM_GRAIN_SIZE) {
+        _ranges.push_back({ first, std::min(TRANSFORM_GRAIN_SIZE, _transforms.size() - first), first });
+    }
+    write_ranges(time_s, _ranges, transforms, jobs);
+}
+
+uint32_t Scene::write_visible_transforms(double time_s, const Frustum& frustum, glm::mat4 *transforms, JobSystem& jobs) {
+    const auto begin = std::chrono::steady_clock::now();
+
+    BvhCullCounters counters {};
+    _visible.clear();
+    _bvh.cull(frustum, _visible, counters);
+
+    // Whole subtrees come back as one range, so split them up again to spread them over the job system
+    _ranges.clear();
+    uint32_t num_written = 0;
+    for (const auto& visible : _visible) {
+        for (uint32_t offset = 0; offset < visible.count; offset += TRANSFORM_GRAIN_SIZE) {
+            const auto count = std::min(TRANSFORM_GRAIN_SIZE, visible.count - offset);
+            _ranges.push_back({ visible.first + offset, count, num_written });
+            num_written += count;
+        }
+    }
+
+    const std::chrono::duration<double, std::milli> time = std::chrono::steady_clock::now() - begin;
+    ++_culling_statistics.num_frames;
+    _culling_statistics.nodes_tested += static_cast<double>(counters.nodes_tested);
+    _culling_statistics.nodes_culled += static_cast<double>(counters.nodes_culled);
+    _culling_statistics.instances_tested += static_cast<double>(counters.objects_tested);
+    _culling_statistics.instances_visible += static_cast<double>(counters.objects_visible);
+    _culling_statistics.average_ms += time.count();
+
+    write_ranges(time_s, _ranges, transforms, jobs);
+    return num_written;
+}
+
+void Scene::write_ranges(double time_s, const std::vector<TransformRange>& ranges, glm::mat4 *transforms, JobSystem& jobs) {
+    const auto begin = std::chrono::steady_clock::now();
+
+    jobs.parallel_for(static_cast<uint32_t>(ranges.size()), 1, [&](uint32_t first_range, uint32_t end_range) {
+        for (uint32_t r = first_range; r < end_range; ++r) {
+            const auto& range = ranges[r];
+            for (uint32_t i = range.first; i < range.first + range.count; ++i) {
+                const auto angle = _phases[i] + static_cast<float>(std::fmod(time_s * _angular_velocities[i], glm::two_pi<double>()));
+                _transforms.set_rotation(i, glm::angleAxis(angle, glm::vec3(0.0f, 1.0f, 0.0f)));
+            }
+            _transforms.write_matrices(transforms + range.output, range.first, range.first + range.count, _statistics.kernel);
+        }
+    });
+
+    const std::chrono::duration<double, std::milli> time = std::chrono::steady_clock::now() - begin;
+    ++_statistics.num_frames;
+    _statistics.average_ms += time.count();
+    _statistics.max_ms = std::max(_statistics.max_ms, time.count());
+}
+
+TransformStatistics Scene::transform_statistics() const noexcept {
+    auto ret = _statistics;
+    if (ret.num_frames) {
+        ret.average_ms /= ret.num_frames;
+    }
+    return ret;
+}
+
+CullingStatistics Scene::culling_statistics() const noexcept {
+    auto ret = _culling_statistics;
+    if (ret.num_frames) {
+        ret.nodes_tested /= ret.num_frames;
+        ret.nodes_culled /= ret.num_frames;
+        ret.instances_tested /= ret.num_frames;
+        ret.instances_visible /= ret.num_frames;
+        ret.average_ms /= ret.num_frames;
+    }
+    return ret;
+}
@@ -0,0 +1,77 @@
+#pragma once
+
+#include "Bvh.hpp"
+#include "Frustum.hpp"
+#include "TransformStore.hpp"
+
+#include "JobSystem.hpp"
+
+#include <glm/mat4x4.hpp>
+
+#include <cstdint>
+#include <vector>
+
+inline constexpr uint32_t MAX_SCENE_INSTANCES = 1'000'000;
+
+struct TransformStatistics {
+    uint32_t num_frames;
+    uint32_t num_instances;
+    TransformKernel kernel;
+    // Job system threads the instances are split between
+    size_t num_threads;
+    // CPU time spent animating and writing a frame's instance transforms
+    double average_ms, max_ms;
+};
+
+struct CullingStatistics {
+    uint32_t num_frames;
+    uint32_t num_instances;
+    size_t num_nodes;
+    // Averages per frame
+    double nodes_tested, nodes_culled, instances_tested, instances_visible;
+    double average_ms;
+};
+
+// Copies of the example mesh laid out in a cube, each spinning at its own rate. The first
+// instance never moves, so a scene of one looks exactly like the original single draw.
+//
+// Instances only spin about their own origin, so their bounding spheres never move and the
+// hierarchy over them is built once. Instances are stored in hierarchy order.
+class Scene {
+public:
+    // bounding_radius is the radius of the mesh's bounding sphere around its origin
+    Scene(uint32_t num_instances, float bounding_radius);
+
+    uint32_t num_instances() const noexcept;
+
+    // Animates every instance to the given time and writes their model matrices, which must be 32 byte
+    // aligned. Large scenes are split into ranges that run on the job system.
+    void write_transforms(double time_s, glm::mat4 *transforms, JobSystem& jobs);
+    // Like write_transforms(), but only for instances intersecting the frustum, packed together.
+    // Returns the number of matrices written.
+    uint32_t write_visible_transforms(double time_s, const Frustum& frustum, glm::mat4 *transforms, JobSystem& jobs);
+
+    TransformStatistics transform_statistics() const noexcept;
+    CullingStatistics culling_statistics() const noexcept;
+
+private:
+    // Instances [first, first + count) written to transforms[output]
+    struct TransformRange {
+        uint32_t first, count, output;
+    };
+
+    void write_ranges(double time_s, const std::vector<TransformRange>& ranges, glm::mat4 *transforms, JobSystem& jobs);
+
+private:
+    TransformStore _transforms;
+    // Rotation about the vertical axis, in radians and radians per second
+    std::vector<float> _phases, _angular_velocities;
+    Bvh _bvh;
+
+    std::vector<VisibleRange> _visible;
+    std::vector<TransformRange> _ranges;
+
+    // Sums over every written or culled frame
+    TransformStatistics _statistics;
+    CullingStatistics _culling_statistics;
+};
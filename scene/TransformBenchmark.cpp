@@ -0,0 +1,132 @@
+#include "TransformStore.hpp"
+
+#include "JobSystem.hpp"
+
+#include <glm/gtx/transform.hpp>
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <limits>
+#include <memory>
+#include <new>
+#include <thread>
+#include <vector>
+
+static constexpr std::array BENCHMARK_SIZES { 10'000u, 100'000u, 1'000'000u };
+// Matches the grain size the scene uses
+static constexpr uint32_t JOB_GRAIN_SIZE = 2048;
+// The fastest of several runs is reported, to keep scheduling noise out of the comparison
+static constexpr int BENCHMARK_RUNS = 10;
+
+struct AlignedFree {
+    void operator()(void *p) const noexcept {
+        std::free(p);
+    }
+};
+
+template<typename F>
+static double fastest_run_ms(F&& f) {
+    auto ret = std::numeric_limits<double>::max();
+    for (int run = 0; run < BENCHMARK_RUNS; ++run) {
+        const auto begin = std::chrono::steady_clock::now();
+        f();
+        const std::chrono::duration<double, std::milli> time = std::chrono::steady_clock::now() - begin;
+        ret = std::min(ret, time.count());
+    }
+    return ret;
+}
+
+static void print_result(const char *name, uint32_t num_objects, double ms) {
+    std::printf("  %-12s %8.3fms %7.2fns/object\n", name, ms, ms * 1e6 / num_objects);
+}
+
+// Times building world matrices with per-object glm calls against each TransformStore kernel,
+// for a range of object counts, and prints the results
+static void run_transform_benchmark() {
+    for (const auto num_objects : BENCHMARK_SIZES) {
+        std::vector<glm::vec3> positions(num_objects), scales(num_objects);
+        std::vector<glm::quat> rotations(num_objects);
+        TransformStore store(num_objects);
+        for (uint32_t i = 0; i < num_objects; ++i) {
+            positions[i] = glm::vec3(static_cast<float>(i % 100), static_cast<float>(i / 100 % 100), static_cast<float>(i / 10'000));
+            rotations[i] = glm::angleAxis(static_cast<float>(i) * 0.01f, glm::normalize(glm::vec3(1.0f, 2.0f, 3.0f)));
+            scales[i] = glm::vec3(1.0f + static_cast<float>(i % 3));
+            store.set_position(i, positions[i]);
+            store.set_rotation(i, rotations[i]);
+            store.set_scale(i, scales[i]);
+        }
+
+        const std::unique_ptr<glm::mat4, AlignedFree> matrices(static_cast<glm::mat4 *>(std::aligned_alloc(64, num_objects * sizeof(glm::mat4))));
+        if (!matrices) {
+            throw std::bad_alloc();
+        }
+
+        std::printf("%u objects:\n", num_objects);
+        print_result("glm", num_objects, fastest_run_ms([&] {
+            for (uint32_t i = 0; i < num_objects; ++i) {
+                matrices.get()[i] = glm::translate(positions[i]) * glm::mat4_cast(rotations[i]) * glm::scale(scales[i]);
+            }
+        }));
+
+        const auto best_kernel = TransformStore::best_kernel();
+        for (const auto kernel : { TransformKernel::Scalar, TransformKernel::Sse, TransformKernel::Avx2 }) {
+            if (kernel > best_kernel) {
+                break;
+            }
+            print_result(to_string(kernel), num_objects, fastest_run_ms([&] {
+                store.write_matrices(matrices.get(), kernel);
+            }));
+        }
+    }
+}
+
+// Times animating and writing the largest benchmark scene on job systems of increasing size, and
+// prints how well it scales with the number of threads
+static void run_job_scaling_benchmark() {
+    const auto num_objects = BENCHMARK_SIZES.back();
+    TransformStore store(num_objects);
+    std::vector<float> angles(num_objects);
+    for (uint32_t i = 0; i < num_objects; ++i) {
+        store.set_position(i, glm::vec3(static_cast<float>(i % 100), static_cast<float>(i / 100 % 100), static_cast<float>(i / 10'000)));
+        angles[i] = static_cast<float>(i) * 0.01f;
+    }
+
+    const std::unique_ptr<glm::mat4, AlignedFree> matrices(static_cast<glm::mat4 *>(std::aligned_alloc(64, num_objects * sizeof(glm::mat4))));
+    if (!matrices) {
+        throw std::bad_alloc();
+    }
+
+    const auto max_threads = std::max(std::thread::hardware_concurrency(), 1u);
+    std::vector<uint32_t> thread_counts;
+    for (uint32_t num_threads = 1; num_threads < max_threads; num_threads *= 2) {
+        thread_counts.push_back(num_threads);
+    }
+    thread_counts.push_back(max_threads);
+
+    std::printf("%u objects with the %s kernel:\n", num_objects, to_string(TransformStore::best_kernel()));
+    double single_thread_ms = 0.0;
+    for (const auto num_threads : thread_counts) {
+        JobSystem jobs(num_threads - 1);
+        const auto ms = fastest_run_ms([&] {
+            jobs.parallel_for(num_objects, JOB_GRAIN_SIZE, [&](uint32_t begin, uint32_t end) {
+                for (uint32_t i = begin; i < end; ++i) {
+                    store.set_rotation(i, glm::angleAxis(angles[i], glm::vec3(0.0f, 1.0f, 0.0f)));
+                }
+                store.write_matrices(matrices.get() + begin, begin, end);
+            });
+        });
+        if (1 == num_threads) {
+            single_thread_ms = ms;
+        }
+        std::printf("  %3u threads %8.3fms %5.2fx\n", num_threads, ms, single_thread_ms / ms);
+    }
+}
+
+int main() {
+    run_transform_benchmark();
+    run_job_scaling_benchmark();
+    return 0;
+}
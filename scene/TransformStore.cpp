@@ -0,0 +1,253 @@
+#include "TransformStore.hpp"
+
+#if defined(__x86_64__)
+#include <immintrin.h>
+#endif
+
+namespace {
+
+struct Components {
+    const float *position[3];
+    const float *rotation[4];
+    const float *scale[3];
+};
+
+}
+
+// Every kernel writes object begin to out and stops at end, or at the last full batch for the SIMD ones
+static void write_scalar(const Components& c, uint32_t begin, uint32_t end, float *out) noexcept {
+    for (uint32_t i = begin; i < end; ++i) {
+        const float x = c.rotation[0][i], y = c.rotation[1][i], z = c.rotation[2][i], w = c.rotation[3][i];
+        const float sx = c.scale[0][i], sy = c.scale[1][i], sz = c.scale[2][i];
+        const float xx = x * x, yy = y * y, zz = z * z;
+        const float xy = x * y, xz = x * z, yz = y * z;
+        const float wx = w * x, wy = w * y, wz = w * z;
+
+        float *m = out + 16 * static_cast<size_t>(i - begin);
+        m[0] = (1.0f - 2.0f * (yy + zz)) * sx;
+        m[1] = 2.0f * (xy + wz) * sx;
+        m[2] = 2.0f * (xz - wy) * sx;
+        m[3] = 0.0f;
+        m[4] = 2.0f * (xy - wz) * sy;
+        m[5] = (1.0f - 2.0f * (xx + zz)) * sy;
+        m[6] = 2.0f * (yz + wx) * sy;
+        m[7] = 0.0f;
+        m[8] = 2.0f * (xz + wy) * sz;
+        m[9] = 2.0f * (yz - wx) * sz;
+        m[10] = (1.0f - 2.0f * (xx + yy)) * sz;
+        m[11] = 0.0f;
+        m[12] = c.position[0][i];
+        m[13] = c.position[1][i];
+        m[14] = c.position[2][i];
+        m[15] = 1.0f;
+    }
+}
+
+#if defined(__x86_64__)
+
+// Turns one column of four objects, held one row per register, into that column of each object's matrix
+static void store_column_sse(float *out, size_t column, __m128 r0, __m128 r1, __m128 r2, __m128 r3) noexcept {
+    _MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+    _mm_stream_ps(out + column * 4, r0);
+    _mm_stream_ps(out + column * 4 + 16, r1);
+    _mm_stream_ps(out + column * 4 + 32, r2);
+    _mm_stream_ps(out + column * 4 + 48, r3);
+}
+
+static uint32_t write_sse(const Components& c, uint32_t begin, uint32_t end, float *out) noexcept {
+    const auto zero = _mm_setzero_ps();
+    const auto one = _mm_set1_ps(1.0f);
+    const auto two = _mm_set1_ps(2.0f);
+
+    uint32_t i = begin;
+    for (; i + 4 <= end; i += 4) {
+        const auto x = _mm_loadu_ps(c.rotation[0] + i), y = _mm_loadu_ps(c.rotation[1] + i);
+        const auto z = _mm_loadu_ps(c.rotation[2] + i), w = _mm_loadu_ps(c.rotation[3] + i);
+        const auto sx = _mm_loadu_ps(c.scale[0] + i), sy = _mm_loadu_ps(c.scale[1] + i), sz = _mm_loadu_ps(c.scale[2] + i);
+
+        const auto x2 = _mm_mul_ps(two, x), y2 = _mm_mul_ps(two, y), z2 = _mm_mul_ps(two, z);
+        const auto xx = _mm_mul_ps(x, x2), yy = _mm_mul_ps(y, y2), zz = _mm_mul_ps(z, z2);
+        const auto xy = _mm_mul_ps(x, y2), xz = _mm_mul_ps(x, z2), yz = _mm_mul_ps(y, z2);
+        const auto wx = _mm_mul_ps(w, x2), wy = _mm_mul_ps(w, y2), wz = _mm_mul_ps(w, z2);
+
+        float *m = out + 16 * static_cast<size_t>(i - begin);
+        store_column_sse(m, 0,
+            _mm_mul_ps(_mm_sub_ps(one, _mm_add_ps(yy, zz)), sx),
+            _mm_mul_ps(_mm_add_ps(xy, wz), sx),
+            _mm_mul_ps(_mm_sub_ps(xz, wy), sx),
+            zero);
+        store_column_sse(m, 1,
+            _mm_mul_ps(_mm_sub_ps(xy, wz), sy),
+            _mm_mul_ps(_mm_sub_ps(one, _mm_add_ps(xx, zz)), sy),
+            _mm_mul_ps(_mm_add_ps(yz, wx), sy),
+            zero);
+        store_column_sse(m, 2,
+            _mm_mul_ps(_mm_add_ps(xz, wy), sz),
+            _mm_mul_ps(_mm_sub_ps(yz, wx), sz),
+            _mm_mul_ps(_mm_sub_ps(one, _mm_add_ps(xx, yy)), sz),
+            zero);
+        store_column_sse(m, 3,
+            _mm_loadu_ps(c.position[0] + i),
+            _mm_loadu_ps(c.position[1] + i),
+            _mm_loadu_ps(c.position[2] + i),
+            one);
+    }
+    return i;
+}
+
+#define AVX2_TARGET __attribute__((target("avx2")))
+
+// Transposes each 128-bit half separately, so register k then holds a column of object k in its
+// low half and of object k + 4 in its high half
+AVX2_TARGET static void transpose_halves(__m256& r0, __m256& r1, __m256& r2, __m256& r3) noexcept {
+    const auto t0 = _mm256_unpacklo_ps(r0, r1), t1 = _mm256_unpackhi_ps(r0, r1);
+    const auto t2 = _mm256_unpacklo_ps(r2, r3), t3 = _mm256_unpackhi_ps(r2, r3);
+    r0 = _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(1, 0, 1, 0));
+    r1 = _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(3, 2, 3, 2));
+    r2 = _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(1, 0, 1, 0));
+    r3 = _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(3, 2, 3, 2));
+}
+
+// Stores two adjacent columns of eight objects, given as transposed halves, 32 bytes per object
+AVX2_TARGET static void store_column_pair_avx2(float *out, size_t first_column, const __m256 (&a)[4], const __m256 (&b)[4]) noexcept {
+    for (size_t k = 0; k < 4; ++k) {
+        _mm256_stream_ps(out + 16 * k + first_column * 4, _mm256_permute2f128_ps(a[k], b[k], 0x20));
+        _mm256_stream_ps(out + 16 * (k + 4) + first_column * 4, _mm256_permute2f128_ps(a[k], b[k], 0x31));
+    }
+}
+
+AVX2_TARGET static uint32_t write_avx2(const Components& c, uint32_t begin, uint32_t end, float *out) noexcept {
+    const auto zero = _mm256_setzero_ps();
+    const auto one = _mm256_set1_ps(1.0f);
+    const auto two = _mm256_set1_ps(2.0f);
+
+    uint32_t i = begin;
+    for (; i + 8 <= end; i += 8) {
+        const auto x = _mm256_loadu_ps(c.rotation[0] + i), y = _mm256_loadu_ps(c.rotation[1] + i);
+        const auto z = _mm256_loadu_ps(c.rotation[2] + i), w = _mm256_loadu_ps(c.rotation[3] + i);
+        const auto sx = _mm256_loadu_ps(c.scale[0] + i), sy = _mm256_loadu_ps(c.scale[1] + i), sz = _mm256_loadu_ps(c.scale[2] + i);
+
+        const auto x2 = _mm256_mul_ps(two, x), y2 = _mm256_mul_ps(two, y), z2 = _mm256_mul_ps(two, z);
+        const auto xx = _mm256_mul_ps(x, x2), yy = _mm256_mul_ps(y, y2), zz = _mm256_mul_ps(z, z2);
+        const auto xy = _mm256_mul_ps(x, y2), xz = _mm256_mul_ps(x, z2), yz = _mm256_mul_ps(y, z2);
+        const auto wx = _mm256_mul_ps(w, x2), wy = _mm256_mul_ps(w, y2), wz = _mm256_mul_ps(w, z2);
+
+        __m256 column0[4] {
+            _mm256_mul_ps(_mm256_sub_ps(one, _mm256_add_ps(yy, zz)), sx),
+            _mm256_mul_ps(_mm256_add_ps(xy, wz), sx),
+            _mm256_mul_ps(_mm256_sub_ps(xz, wy), sx),
+            zero
+        };
+        __m256 column1[4] {
+            _mm256_mul_ps(_mm256_sub_ps(xy, wz), sy),
+            _mm256_mul_ps(_mm256_sub_ps(one, _mm256_add_ps(xx, zz)), sy),
+            _mm256_mul_ps(_mm256_add_ps(yz, wx), sy),
+            zero
+        };
+        __m256 column2[4] {
+            _mm256_mul_ps(_mm256_add_ps(xz, wy), sz),
+            _mm256_mul_ps(_mm256_sub_ps(yz, wx), sz),
+            _mm256_mul_ps(_mm256_sub_ps(one, _mm256_add_ps(xx, yy)), sz),
+            zero
+        };
+        __m256 column3[4] {
+            _mm256_loadu_ps(c.position[0] + i),
+            _mm256_loadu_ps(c.position[1] + i),
+            _mm256_loadu_ps(c.position[2] + i),
+            one
+        };
+        for (auto *column : { &column0, &column1, &column2, &column3 }) {
+            transpose_halves((*column)[0], (*column)[1], (*column)[2], (*column)[3]);
+        }
+
+        float *m = out + 16 * static_cast<size_t>(i - begin);
+        store_column_pair_avx2(m, 0, column0, column1);
+        store_column_pair_avx2(m, 2, column2, column3);
+    }
+    return i;
+}
+
+#endif
+
+const char *to_string(TransformKernel kernel) noexcept {
+    switch (kernel) {
+    case TransformKernel::Scalar:
+        return "scalar";
+    case TransformKernel::Sse:
+        return "SSE";
+    case TransformKernel::Avx2:
+        return "AVX2";
+    }
+    return "unknown";
+}
+
+TransformStore::TransformStore(uint32_t num_transforms)
+    :_position_x(num_transforms, 0.0f)
+    ,_position_y(num_transforms, 0.0f)
+    ,_position_z(num_transforms, 0.0f)
+    ,_rotation_x(num_transforms, 0.0f)
+    ,_rotation_y(num_transforms, 0.0f)
+    ,_rotation_z(num_transforms, 0.0f)
+    ,_rotation_w(num_transforms, 1.0f)
+    ,_scale_x(num_transforms, 1.0f)
+    ,_scale_y(num_transforms, 1.0f)
+    ,_scale_z(num_transforms, 1.0f)
+{}
+
+uint32_t TransformStore::size() const noexcept {
+    return static_cast<uint32_t>(_position_x.size());
+}
+
+void TransformStore::set_position(uint32_t index, const glm::vec3& position) noexcept {
+    _position_x[index] = position.x;
+    _position_y[index] = position.y;
+    _position_z[index] = position.z;
+}
+
+void TransformStore::set_rotation(uint32_t index, const glm::quat& rotation) noexcept {
+    _rotation_x[index] = rotation.x;
+    _rotation_y[index] = rotation.y;
+    _rotation_z[index] = rotation.z;
+    _rotation_w[index] = rotation.w;
+}
+
+void TransformStore::set_scale(uint32_t index, const glm::vec3& scale) noexcept {
+    _scale_x[index] = scale.x;
+    _scale_y[index] = scale.y;
+    _scale_z[index] = scale.z;
+}
+
+TransformKernel TransformStore::best_kernel() noexcept {
+#if defined(__x86_64__)
+    // SSE2 is part of the x86-64 baseline
+    return __builtin_cpu_supports("avx2") ? TransformKernel::Avx2 : TransformKernel::Sse;
+#else
+    return TransformKernel::Scalar;
+#endif
+}
+
+void TransformStore::write_matrices(glm::mat4 *matrices, TransformKernel kernel) const noexcept {
+    write_matrices(matrices, 0, size(), kernel);
+}
+
+void TransformStore::write_matrices(glm::mat4 *matrices, uint32_t begin, uint32_t end, TransformKernel kernel) const noexcept {
+    const Components components {
+        .position = { _position_x.data(), _position_y.data(), _position_z.data() },
+        .rotation = { _rotation_x.data(), _rotation_y.data(), _rotation_z.data(), _rotation_w.data() },
+        .scale = { _scale_x.data(), _scale_y.data(), _scale_z.data() }
+    };
+    auto *out = reinterpret_cast<float *>(matrices);
+
+    // The SIMD kernels stop at the last full batch and leave the remainder to the scalar one
+    uint32_t done = begin;
+#if defined(__x86_64__)
+    if (TransformKernel::Avx2 == kernel) {
+        done = write_avx2(components, done, end, out);
+    }
+    if (TransformKernel::Scalar != kernel) {
+        done = write_sse(components, done, end, out + 16 * static_cast<size_t>(done - begin));
+        _mm_sfence();
+    }
+#endif
+    write_scalar(components, done, end, out + 16 * static_cast<size_t>(done - begin));
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <glm/gtc/quaternion.hpp>
+#include <glm/mat4x4.hpp>
+#include <glm/vec3.hpp>
+
+#include <cstdint>
+#include <vector>
+
+enum class TransformKernel {
+    Scalar,
+    Sse,
+    Avx2
+};
+
+const char *to_string(TransformKernel kernel) noexcept;
+
+// Translation, rotation and scale of many objects, stored as one array per component so that
+// world matrices can be built several objects at a time. Every object starts at the identity.
+class TransformStore {
+public:
+    explicit TransformStore(uint32_t num_transforms);
+
+    uint32_t size() const noexcept;
+
+    void set_position(uint32_t index, const glm::vec3& position) noexcept;
+    void set_rotation(uint32_t index, const glm::quat& rotation) noexcept;
+    void set_scale(uint32_t index, const glm::vec3& scale) noexcept;
+
+    // Fastest kernel the CPU supports
+    static TransformKernel best_kernel() noexcept;
+
+    // Writes the column-major world matrix of every object. Matrices must be 16 byte aligned, 32 for
+    // AVX2, and are written with non-temporal stores as they usually go straight to mapped GPU memory.
+    void write_matrices(glm::mat4 *matrices, TransformKernel kernel = best_kernel()) const noexcept;
+    // Writes the matrices of objects [begin, end) only, to matrices[0, end - begin), so that ranges
+    // can be written by different threads or packed together
+    void write_matrices(glm::mat4 *matrices, uint32_t begin, uint32_t end, TransformKernel kernel = best_kernel()) const noexcept;
+
+private:
+    std::vector<float> _position_x, _position_y, _position_z;
+    std::vector<float> _rotation_x, _rotation_y, _rotation_z, _rotation_w;
+    std::vector<float> _scale_x, _scale_y, _scale_z;
+};
@@ -0,0 +1,32 @@
+#version 450
+
+layout(location=0)
+in vec3 in_position;
+
+layout(location=1)
+in vec4 in_color;
+
+layout(binding=0)
+uniform MATRIX_UNIFORMS {
+    mat4 u_view;
+    mat4 u_projection;
+};
+
+layout(std430, binding=1)
+readonly buffer INSTANCE_TRANSFORMS {
+    mat4 u_models[];
+};
+
+// Written by cull.comp, the instances of the indirect draw that survived culling
+layout(std430, binding=2)
+readonly buffer VISIBLE_INSTANCES {
+    uint u_visible_instances[];
+};
+
+layout(location=0)
+out vec4 out_color;
+
+void main() {
+    gl_Position = u_projection * u_view * u_models[u_visible_instances[gl_InstanceIndex]] * vec4(in_position, 1.0);
+    out_color = in_color;
+}
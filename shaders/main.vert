@@ -8,14 +8,19 @@ in vec4 in_color;
 
 layout(binding=0)
 uniform MATRIX_UNIFORMS {
-    mat4 u_modelview;
+    mat4 u_view;
     mat4 u_projection;
 };
 
+layout(std430, binding=1)
+readonly buffer INSTANCE_TRANSFORMS {
+    mat4 u_models[];
+};
+
 layout(location=0)
 out vec4 out_color;
 
 void main() {
-    gl_Position = u_projection * u_modelview * vec4(in_position, 1.0);
+    gl_Position = u_projection * u_view * u_models[gl_InstanceIndex] * vec4(in_position, 1.0);
     out_color = in_color;
-}
\ No newline at end of file
+}
@@ -0,0 +1,178 @@
+#include "ComputeQueue.hpp"
+
+#include "Common.hpp"
+
+#include <volk.h>
+
+#include <stdexcept>
+#include <utility>
+
+ComputeQueue::ComputeQueue()
+    :_device(nullptr)
+    ,_queue(nullptr)
+    ,_queue_family(0)
+    ,_graphics_queue_family(0)
+    ,_timeline(nullptr)
+    ,_timeline_value(0)
+    ,_frame_value(0)
+    ,_graphics_wait(0)
+    ,_recording_frame(SIZE_MAX)
+{}
+
+void ComputeQueue::destroy() noexcept {
+    if (!_device) {
+        return;
+    }
+
+    if (_timeline_value) {
+        const VkSemaphoreWaitInfo wait_info {
+            .sType = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO,
+            .semaphoreCount = 1,
+            .pSemaphores = &_timeline,
+            .pValues = &_timeline_value
+        };
+        vkWaitSemaphores(_device, &wait_info, UINT64_MAX);
+    }
+
+    for (const auto& frame_data : _frame_data) {
+        vkDestroyCommandPool(_device, frame_data.command_pool, nullptr);
+    }
+    _frame_data.clear();
+    _timestamps.destroy();
+    vkDestroySemaphore(_device, _timeline, nullptr);
+    _timeline = nullptr;
+    _device = nullptr;
+}
+
+void ComputeQueue::init(VkDevice device, VkPhysicalDevice physical_device, VkQueue queue, uint32_t queue_family, uint32_t graphics_queue_family, size_t num_frames) {
+    _device = device;
+    _queue = queue;
+    _queue_family = queue_family;
+    _graphics_queue_family = graphics_queue_family;
+
+    const VkSemaphoreTypeCreateInfo timeline_type_create_info {
+        .sType = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO,
+        .semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE,
+        .initialValue = 0
+    };
+    const VkSemaphoreCreateInfo timeline_create_info {
+        .sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO,
+        .pNext = &timeline_type_create_info
+    };
+    check_success(vkCreateSemaphore(_device, &timeline_create_info, nullptr, &_timeline));
+
+    _frame_data.resize(num_frames);
+    for (auto& frame_data : _frame_data) {
+        const VkCommandPoolCreateInfo command_pool_create_info {
+            .sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO,
+            .flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT,
+            .queueFamilyIndex = _queue_family
+        };
+        check_success(vkCreateCommandPool(_device, &command_pool_create_info, nullptr, &frame_data.command_pool));
+
+        const VkCommandBufferAllocateInfo command_buffer_allocate_info {
+            .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO,
+            .commandPool = frame_data.command_pool,
+            .level = VK_COMMAND_BUFFER_LEVEL_PRIMARY,
+            .commandBufferCount = 1
+        };
+        check_success(vkAllocateCommandBuffers(_device, &command_buffer_allocate_info, &frame_data.command_buffer));
+        frame_data.timeline_value = 0;
+    }
+
+    _timestamps.init(_device, physical_device, _queue_family, num_frames);
+}
+
+bool ComputeQueue::is_async() const noexcept {
+    return _queue_family != _graphics_queue_family;
+}
+
+uint32_t ComputeQueue::queue_family() const noexcept {
+    return _queue_family;
+}
+
+VkSemaphore ComputeQueue::timeline() noexcept {
+    return _timeline;
+}
+
+void ComputeQueue::wait_for_frame(size_t frame_index) const {
+    wait(_frame_data[frame_index].timeline_value);
+}
+
+VkCommandBuffer ComputeQueue::begin(size_t frame_index) {
+    if (SIZE_MAX != _recording_frame) {
+        throw std::runtime_error("Compute work is already being recorded");
+    }
+
+    auto& frame_data = _frame_data[frame_index];
+    wait(frame_data.timeline_value);
+    check_success(vkResetCommandPool(_device, frame_data.command_pool, 0));
+
+    const VkCommandBufferBeginInfo command_buffer_begin_info {
+        .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
+        .flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT
+    };
+    check_success(vkBeginCommandBuffer(frame_data.command_buffer, &command_buffer_begin_info));
+    _timestamps.write_begin(frame_data.command_buffer, frame_index);
+
+    _recording_frame = frame_index;
+    return frame_data.command_buffer;
+}
+
+uint64_t ComputeQueue::submit() {
+    auto& frame_data = _frame_data[std::exchange(_recording_frame, SIZE_MAX)];
+    _timestamps.write_end(frame_data.command_buffer, &frame_data - _frame_data.data());
+    check_success(vkEndCommandBuffer(frame_data.command_buffer));
+
+    const auto timeline_value = _timeline_value + 1;
+    const VkCommandBufferSubmitInfo command_buffer_info {
+        .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_SUBMIT_INFO,
+        .commandBuffer = frame_data.command_buffer
+    };
+    const VkSemaphoreSubmitInfo signal_semaphore_info {
+        .sType = VK_STRUCTURE_TYPE_SEMAPHORE_SUBMIT_INFO,
+        .semaphore = _timeline,
+        .value = timeline_value,
+        .stageMask = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT
+    };
+    const VkSubmitInfo2 submit_info {
+        .sType = VK_STRUCTURE_TYPE_SUBMIT_INFO_2,
+        .commandBufferInfoCount = 1,
+        .pCommandBufferInfos = &command_buffer_info,
+        .signalSemaphoreInfoCount = 1,
+        .pSignalSemaphoreInfos = &signal_semaphore_info
+    };
+    check_success(vkQueueSubmit2(_queue, 1, &submit_info, nullptr));
+
+    _timeline_value = timeline_value;
+    frame_data.timeline_value = timeline_value;
+    _frame_value = timeline_value;
+    return timeline_value;
+}
+
+uint64_t ComputeQueue::num_submitted() const noexcept {
+    // Every submission signals the next timeline value
+    return _timeline_value;
+}
+
+uint64_t ComputeQueue::graphics_wait() const noexcept {
+    return _graphics_wait;
+}
+
+void ComputeQueue::end_frame() noexcept {
+    _graphics_wait = std::exchange(_frame_value, 0);
+}
+
+std::optional<GpuSpan> ComputeQueue::take_span(size_t frame_index, const TimestampCalibration& calibration) noexcept {
+    return _timestamps.take_span(frame_index, calibration);
+}
+
+void ComputeQueue::wait(uint64_t timeline_value) const {
+    const VkSemaphoreWaitInfo wait_info {
+        .sType = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO,
+        .semaphoreCount = 1,
+        .pSemaphores = &_timeline,
+        .pValues = &timeline_value
+    };
+    check_success(vkWaitSemaphores(_device, &wait_info, UINT64_MAX));
+}
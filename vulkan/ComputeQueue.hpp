@@ -0,0 +1,79 @@
+#pragma once
+
+#include "TimestampQueries.hpp"
+
+#include <vector>
+
+struct ComputeOverlapStatistics {
+    // Frames that submitted compute work at all, whether or not they could be timed
+    uint64_t num_submitted_frames;
+    uint32_t num_frames;
+    // Averages per frame that submitted compute work
+    double compute_ms, graphics_ms, overlap_ms;
+};
+
+// Per-frame compute work, submitted to the async compute queue family when the device has one
+// and to the graphics queue otherwise. Completion is signalled on a timeline semaphore that the
+// next frame's graphics submission waits on, so a frame's compute runs alongside its graphics and
+// its results are consumed one frame later.
+//
+// Buffers written by compute and read by graphics must either be created with concurrent sharing
+// between the two families or have their ownership transferred.
+class ComputeQueue {
+public:
+    ComputeQueue();
+    ComputeQueue(const ComputeQueue&) = delete;
+    ComputeQueue(ComputeQueue&&) noexcept = delete;
+    ~ComputeQueue() = default;
+
+    ComputeQueue& operator=(const ComputeQueue&) = delete;
+    ComputeQueue& operator=(ComputeQueue&&) noexcept = delete;
+
+    // Waits for all submitted work before destroying anything
+    void destroy() noexcept;
+
+    void init(VkDevice device, VkPhysicalDevice physical_device, VkQueue queue, uint32_t queue_family, uint32_t graphics_queue_family, size_t num_frames);
+
+    // True if work runs on its own queue family, and so can overlap with graphics
+    bool is_async() const noexcept;
+    uint32_t queue_family() const noexcept;
+    VkSemaphore timeline() noexcept;
+
+    // Blocks until the frame's previous work has finished, so the data it read can be rewritten.
+    // Graphics no longer waits on it within the same frame, so waiting on the frame timeline is not enough.
+    void wait_for_frame(size_t frame_index) const;
+    // Starts recording the given frame's compute work, after its previous work has finished
+    VkCommandBuffer begin(size_t frame_index);
+    // Submits the recording started by begin(), returns the timeline value signalled on completion
+    uint64_t submit();
+    uint64_t num_submitted() const noexcept;
+    // Timeline value the current frame's graphics submission must wait on, that of the previous
+    // frame's submission, 0 if it submitted nothing
+    uint64_t graphics_wait() const noexcept;
+    // Called once the frame's graphics work is submitted, the next frame then waits on this frame's work
+    void end_frame() noexcept;
+
+    // Execution span of the frame's last submission, once it has completed
+    std::optional<GpuSpan> take_span(size_t frame_index, const TimestampCalibration& calibration) noexcept;
+
+private:
+    struct FrameData {
+        VkCommandPool command_pool;
+        VkCommandBuffer command_buffer;
+        uint64_t timeline_value;
+    };
+
+    void wait(uint64_t timeline_value) const;
+
+private:
+    VkDevice _device;
+    VkQueue _queue;
+    uint32_t _queue_family, _graphics_queue_family;
+
+    VkSemaphore _timeline;
+    uint64_t _timeline_value, _frame_value, _graphics_wait;
+
+    std::vector<FrameData> _frame_data;
+    size_t _recording_frame;
+    TimestampQueries _timestamps;
+};
@@ -0,0 +1,109 @@
+#include "FrameAllocator.hpp"
+
+#include "Common.hpp"
+
+#include <volk.h>
+
+#include <algorithm>
+#include <cstdio>
+
+static constexpr VkDeviceSize align_up(VkDeviceSize value, VkDeviceSize alignment) noexcept {
+    return (value + alignment - 1) / alignment * alignment;
+}
+
+FrameAllocator::FrameAllocator()
+    :_allocator(nullptr)
+    ,_buffer(nullptr)
+    ,_allocation(nullptr)
+    ,_mapped(nullptr)
+    ,_min_alignment(1)
+    ,_frame_capacity(0)
+    ,_frame_begin(0)
+    ,_frame_offset(0)
+    ,_high_water_mark(0)
+    ,_num_overflows(0)
+{}
+
+void FrameAllocator::destroy() noexcept {
+    if (_allocator) {
+        vmaDestroyBuffer(_allocator, _buffer, _allocation);
+    }
+    _buffer = nullptr;
+    _allocation = nullptr;
+    _mapped = nullptr;
+}
+
+VkBuffer FrameAllocator::buffer() noexcept {
+    return _buffer;
+}
+
+void FrameAllocator::init(VmaAllocator allocator, VkPhysicalDevice physical_device, size_t num_frames, VkDeviceSize frame_capacity,
+    std::span<const uint32_t> queue_families)
+{
+    _allocator = allocator;
+
+    VkPhysicalDeviceProperties physical_device_props;
+    vkGetPhysicalDeviceProperties(physical_device, &physical_device_props);
+    _min_alignment = std::max({
+        physical_device_props.limits.minUniformBufferOffsetAlignment,
+        physical_device_props.limits.minStorageBufferOffsetAlignment,
+        VkDeviceSize{16}
+    });
+    // Non-coherent memory is flushed per region, so keep regions on atom boundaries
+    _frame_capacity = align_up(frame_capacity, std::max(_min_alignment, physical_device_props.limits.nonCoherentAtomSize));
+
+    const VkBufferCreateInfo buffer_create_info {
+        .sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
+        .size = num_frames * _frame_capacity,
+        .usage = VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT
+            | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT,
+        .sharingMode = queue_families.size() > 1 ? VK_SHARING_MODE_CONCURRENT : VK_SHARING_MODE_EXCLUSIVE,
+        .queueFamilyIndexCount = queue_families.size() > 1 ? static_cast<uint32_t>(queue_families.size()) : 0,
+        .pQueueFamilyIndices = queue_families.data()
+    };
+    const VmaAllocationCreateInfo allocation_create_info {
+        .flags = VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT | VMA_ALLOCATION_CREATE_MAPPED_BIT,
+        .usage = VMA_MEMORY_USAGE_AUTO_PREFER_DEVICE,
+        .priority = NORMAL_PRIORITY
+    };
+    VmaAllocationInfo allocation_info;
+    check_success(vmaCreateBuffer(_allocator, &buffer_create_info, &allocation_create_info, &_buffer, &_allocation, &allocation_info));
+    _mapped = static_cast<uint8_t *>(allocation_info.pMappedData);
+}
+
+void FrameAllocator::begin_frame(size_t frame_index) noexcept {
+    _frame_begin = frame_index * _frame_capacity;
+    _frame_offset = _frame_begin;
+}
+
+void FrameAllocator::flush() {
+    if (_frame_offset != _frame_begin) {
+        check_success(vmaFlushAllocation(_allocator, _allocation, _frame_begin, _frame_offset - _frame_begin));
+    }
+}
+
+std::optional<FrameAllocation> FrameAllocator::allocate(VkDeviceSize size, VkDeviceSize alignment) noexcept {
+    const auto offset = align_up(_frame_offset, std::max(alignment, _min_alignment));
+    if (offset + size > _frame_begin + _frame_capacity) {
+        if (!_num_overflows++) {
+            std::fprintf(stderr, "Frame allocator overflow, %llu bytes per frame is not enough\n",
+                static_cast<unsigned long long>(_frame_capacity));
+        }
+        return std::nullopt;
+    }
+
+    _frame_offset = offset + size;
+    _high_water_mark = std::max(_high_water_mark, _frame_offset - _frame_begin);
+    return FrameAllocation {
+        .offset = offset,
+        .data = _mapped + offset
+    };
+}
+
+FrameAllocatorStatistics FrameAllocator::statistics() const noexcept {
+    return {
+        .frame_capacity = _frame_capacity,
+        .high_water_mark = _high_water_mark,
+        .num_overflows = _num_overflows
+    };
+}
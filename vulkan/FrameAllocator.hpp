@@ -0,0 +1,64 @@
+#pragma once
+
+#include <vk_mem_alloc.h>
+
+#include <optional>
+#include <span>
+
+struct FrameAllocation {
+    VkDeviceSize offset;
+    void *data;
+};
+
+struct FrameAllocatorStatistics {
+    VkDeviceSize frame_capacity;
+    // Most bytes used by any single frame
+    VkDeviceSize high_water_mark;
+    uint32_t num_overflows;
+};
+
+// Linear allocator for data written by the CPU once per frame, such as uniforms or dynamic
+// vertices. A single persistently mapped buffer is split into one region per frame in flight,
+// and each region is reset when its frame comes around again.
+class FrameAllocator {
+public:
+    FrameAllocator();
+    FrameAllocator(const FrameAllocator&) = delete;
+    FrameAllocator(FrameAllocator&&) noexcept = delete;
+    ~FrameAllocator() = default;
+
+    FrameAllocator& operator=(const FrameAllocator&) = delete;
+    FrameAllocator& operator=(FrameAllocator&&) noexcept = delete;
+
+    void destroy() noexcept;
+
+    VkBuffer buffer() noexcept;
+
+    // The buffer is shared concurrently if more than one queue family reads it
+    void init(VmaAllocator allocator, VkPhysicalDevice physical_device, size_t num_frames, VkDeviceSize frame_capacity,
+        std::span<const uint32_t> queue_families = {});
+
+    // Starts allocating from the region of the given frame, the GPU must be done with its previous contents
+    void begin_frame(size_t frame_index) noexcept;
+    // Makes the frame's writes visible to the device, must be called before submitting work that reads them
+    void flush();
+
+    // Offsets are aligned to at least the device's uniform and storage buffer offset alignment.
+    // Returns nullopt if the frame's region is exhausted.
+    std::optional<FrameAllocation> allocate(VkDeviceSize size, VkDeviceSize alignment = 0) noexcept;
+
+    FrameAllocatorStatistics statistics() const noexcept;
+
+private:
+    VmaAllocator _allocator;
+    VkBuffer _buffer;
+    VmaAllocation _allocation;
+    uint8_t *_mapped;
+
+    VkDeviceSize _min_alignment;
+    VkDeviceSize _frame_capacity;
+    VkDeviceSize _frame_begin, _frame_offset;
+
+    VkDeviceSize _high_water_mark;
+    uint32_t _num_overflows;
+};
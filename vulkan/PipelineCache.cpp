@@ -0,0 +1,182 @@
+#include "PipelineCache.hpp"
+
+#include "Common.hpp"
+
+#include <volk.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <vector>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+static constexpr char CACHE_DIRECTORY_NAME[] = "WaylandWSIExample";
+static constexpr char CACHE_FILE_NAME[] = "pipeline_cache.bin";
+
+static std::filesystem::path get_cache_directory() {
+    const auto xdg_cache_home = getenv("XDG_CACHE_HOME");
+    if (xdg_cache_home && xdg_cache_home[0] == '/') {
+        return std::filesystem::path(xdg_cache_home) / CACHE_DIRECTORY_NAME;
+    }
+
+    const auto home = getenv("HOME");
+    if (home && home[0] == '/') {
+        return std::filesystem::path(home) / ".cache" / CACHE_DIRECTORY_NAME;
+    }
+
+    return {};
+}
+
+static std::vector<uint8_t> load_cache_file(const std::filesystem::path& path) {
+    std::ifstream file(path, std::ios::binary);
+    std::vector<uint8_t> ret;
+    std::copy(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>(), std::back_inserter(ret));
+    return ret;
+}
+
+// Returns false with errno set if any step failed, the file is only complete once fsync() succeeded
+static bool write_file_synced(const std::filesystem::path& path, const uint8_t *data, size_t size) noexcept {
+    const auto fd = open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        return false;
+    }
+
+    while (size) {
+        const auto written = write(fd, data, size);
+        if (written < 0) {
+            if (EINTR == errno) {
+                continue;
+            }
+            const auto error = errno;
+            close(fd);
+            errno = error;
+            return false;
+        }
+        data += written;
+        size -= static_cast<size_t>(written);
+    }
+
+    if (fsync(fd)) {
+        const auto error = errno;
+        close(fd);
+        errno = error;
+        return false;
+    }
+    return !close(fd);
+}
+
+static bool is_valid_cache_blob(const std::vector<uint8_t>& blob, const VkPhysicalDeviceProperties& physical_device_props) {
+    VkPipelineCacheHeaderVersionOne header;
+    if (blob.size() < sizeof(header)) {
+        return false;
+    }
+    memcpy(&header, blob.data(), sizeof(header));
+
+    return header.headerSize >= sizeof(header)
+        && header.headerSize <= blob.size()
+        && header.headerVersion == VK_PIPELINE_CACHE_HEADER_VERSION_ONE
+        && header.vendorID == physical_device_props.vendorID
+        && header.deviceID == physical_device_props.deviceID
+        && !memcmp(header.pipelineCacheUUID, physical_device_props.pipelineCacheUUID, VK_UUID_SIZE);
+}
+
+PipelineCache::PipelineCache()
+    :_device(nullptr)
+    ,_cache(nullptr)
+    ,_is_warm(false)
+{}
+
+void PipelineCache::destroy() noexcept {
+    vkDestroyPipelineCache(_device, _cache, nullptr);
+    _cache = nullptr;
+}
+
+VkPipelineCache PipelineCache::handle() noexcept {
+    return _cache;
+}
+
+void PipelineCache::init(VkDevice device, VkPhysicalDevice physical_device) {
+    _device = device;
+
+    VkPhysicalDeviceProperties physical_device_props;
+    vkGetPhysicalDeviceProperties(physical_device, &physical_device_props);
+
+    const auto directory = get_cache_directory();
+    if (!directory.empty()) {
+        _path = directory / CACHE_FILE_NAME;
+    }
+
+    std::vector<uint8_t> blob;
+    if (!_path.empty()) {
+        blob = load_cache_file(_path);
+        if (!blob.empty() && !is_valid_cache_blob(blob, physical_device_props)) {
+            std::fprintf(stderr, "Discarding pipeline cache from a different device or driver\n");
+            blob.clear();
+        }
+    }
+    _is_warm = !blob.empty();
+
+    const VkPipelineCacheCreateInfo pipeline_cache_create_info {
+        .sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO,
+        .initialDataSize = blob.size(),
+        .pInitialData = blob.data()
+    };
+    check_success(vkCreatePipelineCache(_device, &pipeline_cache_create_info, nullptr, &_cache));
+}
+
+bool PipelineCache::is_warm() const noexcept {
+    return _is_warm;
+}
+
+void PipelineCache::save() const noexcept {
+    if (!_cache || _path.empty()) {
+        return;
+    }
+
+    size_t size;
+    if (vkGetPipelineCacheData(_device, _cache, &size, nullptr)) {
+        return;
+    }
+    const auto data = std::make_unique_for_overwrite<uint8_t[]>(size);
+    if (vkGetPipelineCacheData(_device, _cache, &size, data.get())) {
+        return;
+    }
+
+    std::error_code ec;
+    std::filesystem::create_directories(_path.parent_path(), ec);
+    if (ec) {
+        std::fprintf(stderr, "Unable to create pipeline cache directory: %s\n", ec.message().c_str());
+        return;
+    }
+
+    // Write to a sibling file, sync it and rename it into place, then sync the directory so the
+    // rename itself is durable. Neither a crash nor a power loss mid-write can then leave a
+    // truncated cache behind for the next launch.
+    auto temporary_path = _path;
+    temporary_path += ".tmp";
+    if (!write_file_synced(temporary_path, data.get(), size)) {
+        std::fprintf(stderr, "Unable to write pipeline cache: %s\n", std::strerror(errno));
+        std::filesystem::remove(temporary_path, ec);
+        return;
+    }
+
+    std::filesystem::rename(temporary_path, _path, ec);
+    if (ec) {
+        std::fprintf(stderr, "Unable to replace pipeline cache: %s\n", ec.message().c_str());
+        std::filesystem::remove(temporary_path, ec);
+        return;
+    }
+
+    const auto directory_fd = open(_path.parent_path().c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (directory_fd >= 0) {
+        fsync(directory_fd);
+        close(directory_fd);
+    }
+}
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+
+#include <filesystem>
+
+class PipelineCache {
+public:
+    PipelineCache();
+    PipelineCache(const PipelineCache&) = delete;
+    PipelineCache(PipelineCache&&) noexcept = delete;
+    ~PipelineCache() = default;
+
+    PipelineCache& operator=(const PipelineCache&) = delete;
+    PipelineCache& operator=(PipelineCache&&) noexcept = delete;
+
+    void destroy() noexcept;
+
+    VkPipelineCache handle() noexcept;
+
+    void init(VkDevice device, VkPhysicalDevice physical_device);
+
+    // True if a valid blob for this device was found on disk
+    bool is_warm() const noexcept;
+
+    // Writes the cache to a temporary file and renames it over the old one
+    void save() const noexcept;
+
+private:
+    VkDevice _device;
+    VkPipelineCache _cache;
+    std::filesystem::path _path;
+    bool _is_warm;
+};
@@ -0,0 +1,117 @@
+#include "PresentWaiter.hpp"
+
+#include <volk.h>
+
+#include <algorithm>
+#include <limits>
+
+// Bounds each wait, so dropping presents or stopping never waits on a surface that is not being shown
+static constexpr uint64_t PRESENT_WAIT_SLICE_NS = 10'000'000;
+
+PresentWaiter::PresentWaiter()
+    :_device(nullptr)
+    ,_stop(false)
+    ,_waiting(false)
+    ,_pending{}
+    ,_pending_begin(0)
+    ,_pending_end(0)
+    ,_latencies_ms{}
+    ,_num_latencies(0)
+{}
+
+PresentWaiter::~PresentWaiter() {
+    stop();
+}
+
+void PresentWaiter::start(VkDevice device) {
+    _device = device;
+    _stop = false;
+    _thread = std::thread(&PresentWaiter::thread_entry, this);
+}
+
+void PresentWaiter::stop() noexcept {
+    if (_thread.joinable()) {
+        {
+            const std::lock_guard lock(_mutex);
+            _stop = true;
+        }
+        _changed.notify_all();
+        _thread.join();
+    }
+}
+
+void PresentWaiter::submitted(VkSwapchainKHR swapchain, uint64_t present_id) {
+    {
+        const std::lock_guard lock(_mutex);
+        if (_pending_end - _pending_begin == _pending.size()) {
+            return;
+        }
+        _pending[_pending_end++ % _pending.size()] = { swapchain, present_id, std::chrono::steady_clock::now() };
+    }
+    _changed.notify_all();
+}
+
+void PresentWaiter::drop_pending() noexcept {
+    std::unique_lock lock(_mutex);
+    _pending_begin = _pending_end;
+    _changed.notify_all();
+    // The current wait still uses the swapchain until it returns, at most one slice later
+    _changed.wait(lock, [this] { return !_waiting; });
+}
+
+bool PresentWaiter::wait_for_pending(size_t max_pending, std::chrono::nanoseconds timeout) {
+    std::unique_lock lock(_mutex);
+    return _changed.wait_for(lock, timeout, [&] { return _pending_end - _pending_begin < max_pending; });
+}
+
+LatencyStatistics PresentWaiter::latency_statistics() const {
+    const std::lock_guard lock(_mutex);
+    const auto num_frames = std::min(_num_latencies, _latencies_ms.size());
+    if (!num_frames) {
+        return {};
+    }
+
+    LatencyStatistics ret {
+        .num_frames = static_cast<uint32_t>(num_frames),
+        .min_ms = std::numeric_limits<double>::max(),
+        .average_ms = 0.0,
+        .max_ms = 0.0
+    };
+    for (size_t i = 0; i < num_frames; ++i) {
+        ret.min_ms = std::min(ret.min_ms, _latencies_ms[i]);
+        ret.max_ms = std::max(ret.max_ms, _latencies_ms[i]);
+        ret.average_ms += _latencies_ms[i];
+    }
+    ret.average_ms /= ret.num_frames;
+    return ret;
+}
+
+void PresentWaiter::thread_entry() noexcept {
+    std::unique_lock lock(_mutex);
+    while (!_stop) {
+        if (_pending_begin == _pending_end) {
+            _changed.wait(lock);
+            continue;
+        }
+
+        const auto present = _pending[_pending_begin % _pending.size()];
+        _waiting = true;
+        lock.unlock();
+        const auto result = vkWaitForPresentKHR(_device, present.swapchain, present.present_id, PRESENT_WAIT_SLICE_NS);
+        const auto displayed_time = std::chrono::steady_clock::now();
+        lock.lock();
+        _waiting = false;
+
+        // Unless it was dropped meanwhile, the present is done with whether it was shown or its
+        // swapchain went out of date. Only presents that were shown record a latency.
+        const bool still_pending = _pending_begin != _pending_end && _pending[_pending_begin % _pending.size()].present_id == present.present_id;
+        if (result != VK_TIMEOUT && still_pending) {
+            ++_pending_begin;
+            if (result == VK_SUCCESS || result == VK_SUBOPTIMAL_KHR) {
+                const std::chrono::duration<double, std::milli> latency = displayed_time - present.submit_time;
+                _latencies_ms[_num_latencies++ % _latencies_ms.size()] = latency.count();
+            }
+        }
+        _changed.notify_all();
+    }
+}
@@ -0,0 +1,67 @@
+#pragma once
+
+#include "wayland/PresentationFeedback.hpp"
+
+#include <vulkan/vulkan.h>
+
+#include <array>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+
+// Blocks in vkWaitForPresentKHR on its own thread for every present that has not been displayed
+// yet. The wait returns as the present reaches the screen, which times the latency from submission
+// to display and lets the queued frame limiter sleep until a present is shown instead of polling.
+class PresentWaiter {
+public:
+    PresentWaiter();
+    PresentWaiter(const PresentWaiter&) = delete;
+    PresentWaiter(PresentWaiter&&) noexcept = delete;
+    ~PresentWaiter();
+
+    PresentWaiter& operator=(const PresentWaiter&) = delete;
+    PresentWaiter& operator=(PresentWaiter&&) noexcept = delete;
+
+    void start(VkDevice device);
+    void stop() noexcept;
+
+    // Present ids must increase with every call
+    void submitted(VkSwapchainKHR swapchain, uint64_t present_id);
+    // Forgets pending presents and waits until the thread no longer uses their swapchain, must be
+    // called before that swapchain is retired
+    void drop_pending() noexcept;
+    // Blocks until fewer than max_pending presents wait to be displayed, returns false on timeout
+    bool wait_for_pending(size_t max_pending, std::chrono::nanoseconds timeout);
+
+    // Time from submission to vkWaitForPresentKHR returning, over the most recent presents
+    LatencyStatistics latency_statistics() const;
+
+private:
+    struct PendingPresent {
+        VkSwapchainKHR swapchain;
+        uint64_t present_id;
+        std::chrono::steady_clock::time_point submit_time;
+    };
+
+    void thread_entry() noexcept;
+
+private:
+    VkDevice _device;
+    std::thread _thread;
+
+    // Guards everything below, the condition variable is signalled whenever any of it changes
+    mutable std::mutex _mutex;
+    std::condition_variable _changed;
+    bool _stop;
+    // Set while the thread waits without the lock held, on the oldest pending present
+    bool _waiting;
+
+    // Only a handful of presents can ever be queued, presents are not tracked while the ring is full
+    std::array<PendingPresent, 16> _pending;
+    size_t _pending_begin, _pending_end;
+
+    std::array<double, PRESENTATION_HISTORY> _latencies_ms;
+    size_t _num_latencies;
+};
@@ -0,0 +1,620 @@
+#include "Common.hpp"
+#include "RecordingWorkers.hpp"
+
+#include "JobSystem.hpp"
+
+#include <volk.h>
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace std::literals;
+
+static constexpr std::array BENCHMARK_DRAW_COUNTS { 1'000u, 10'000u, 100'000u };
+// 0 records straight into the primary command buffer, like WAYLAND_EXAMPLE_RECORDING_SLICES=0
+static constexpr std::array BENCHMARK_SLICES { 0u, 1u, 2u, 4u, 8u, 16u };
+// The fastest of several runs is reported, to keep scheduling noise out of the comparison
+static constexpr int BENCHMARK_RUNS = 10;
+
+// Nothing recorded is ever submitted, the attachments only give the rendering a valid target
+static constexpr VkExtent2D TARGET_SIZE { 64, 64 };
+static constexpr VkFormat COLOR_FORMAT = VK_FORMAT_R8G8B8A8_UNORM;
+static constexpr VkFormat DEPTH_FORMAT = VK_FORMAT_D32_SFLOAT;
+// Room for the matrix uniforms and one instance transform, the only data the shaders bind
+static constexpr VkDeviceSize UNIFORMS_SIZE = 2 * 16 * sizeof(float);
+static constexpr VkDeviceSize TRANSFORMS_SIZE = 16 * sizeof(float);
+static constexpr VkDeviceSize BUFFER_SIZE = 1024;
+
+struct Vertex {
+    std::array<float, 3> position;
+    std::array<uint8_t, 4> color;
+};
+
+static std::vector<uint32_t> load_shader(std::filesystem::path path) {
+    path += ".spv";
+    std::ifstream file("shaders" / path, std::ios::binary);
+    std::vector<uint8_t> raw;
+    std::copy(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>(), std::back_inserter(raw));
+    if (raw.empty()) {
+        throw std::runtime_error("Unable to load shader "s + path.c_str() + ", run the benchmark from the build directory");
+    }
+
+    std::vector<uint32_t> ret(raw.size() / sizeof(uint32_t));
+    memcpy(ret.data(), raw.data(), ret.size() * sizeof(uint32_t));
+    return ret;
+}
+
+template<typename F>
+static double fastest_run_ms(F&& f) {
+    auto ret = std::numeric_limits<double>::max();
+    for (int run = 0; run < BENCHMARK_RUNS; ++run) {
+        const auto begin = std::chrono::steady_clock::now();
+        f();
+        const std::chrono::duration<double, std::milli> time = std::chrono::steady_clock::now() - begin;
+        ret = std::min(ret, time.count());
+    }
+    return ret;
+}
+
+// Records frames the way Renderer::record_command_buffer() does, on a device without a surface and
+// into offscreen attachments, so recording can be timed without opening a window
+class RecordingBenchmark {
+public:
+    RecordingBenchmark();
+    RecordingBenchmark(const RecordingBenchmark&) = delete;
+    RecordingBenchmark(RecordingBenchmark&&) noexcept = delete;
+    ~RecordingBenchmark();
+
+    RecordingBenchmark& operator=(const RecordingBenchmark&) = delete;
+    RecordingBenchmark& operator=(RecordingBenchmark&&) noexcept = delete;
+
+    VkDevice device() noexcept;
+    uint32_t queue_family() const noexcept;
+
+    // Records draw_count draws into the primary command buffer, through the workers' secondary
+    // command buffers if they have any slices
+    void record(JobSystem& jobs, RecordingWorkers& workers, uint32_t draw_count);
+
+private:
+    VkDeviceMemory allocate(const VkMemoryRequirements& requirements);
+    void create_attachment(VkFormat format, VkImageUsageFlags usage, VkImageAspectFlags aspect, size_t index);
+
+private:
+    VkInstance _instance;
+    VkPhysicalDevice _physical_device;
+    uint32_t _queue_family;
+    VkDevice _device;
+
+    std::vector<VkDeviceMemory> _memory;
+    VkBuffer _buffer;
+    std::array<VkImage, 2> _images;
+    std::array<VkImageView, 2> _image_views;
+
+    VkDescriptorSetLayout _descriptor_set_layout;
+    VkPipelineLayout _pipeline_layout;
+    VkDescriptorPool _descriptor_pool;
+    VkDescriptorSet _descriptor_set;
+    VkPipeline _pipeline;
+
+    VkCommandPool _command_pool;
+    VkCommandBuffer _command_buffer;
+};
+
+RecordingBenchmark::RecordingBenchmark()
+    :_instance(nullptr)
+    ,_physical_device(nullptr)
+    ,_queue_family(UINT32_MAX)
+    ,_device(nullptr)
+    ,_buffer(nullptr)
+    ,_images{}
+    ,_image_views{}
+    ,_descriptor_set_layout(nullptr)
+    ,_pipeline_layout(nullptr)
+    ,_descriptor_pool(nullptr)
+    ,_descriptor_set(nullptr)
+    ,_pipeline(nullptr)
+    ,_command_pool(nullptr)
+    ,_command_buffer(nullptr)
+{
+    check_success(volkInitialize());
+
+    const VkApplicationInfo application_info {
+        .sType = VK_STRUCTURE_TYPE_APPLICATION_INFO,
+        .pApplicationName = "WaylandWSIExample recording benchmark",
+        .applicationVersion = 0,
+        .apiVersion = VK_API_VERSION_1_3
+    };
+    const VkInstanceCreateInfo instance_create_info {
+        .sType = VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO,
+        .pApplicationInfo = &application_info
+    };
+    check_success(vkCreateInstance(&instance_create_info, nullptr, &_instance));
+    volkLoadInstanceOnly(_instance);
+
+    uint32_t num_physical_devices;
+    check_success(vkEnumeratePhysicalDevices(_instance, &num_physical_devices, nullptr));
+    const auto physical_devices = std::make_unique_for_overwrite<VkPhysicalDevice[]>(num_physical_devices);
+    check_success(vkEnumeratePhysicalDevices(_instance, &num_physical_devices, physical_devices.get()));
+    for (uint32_t i = 0; i < num_physical_devices && !_physical_device; ++i) {
+        VkPhysicalDeviceProperties physical_device_props;
+        vkGetPhysicalDeviceProperties(physical_devices[i], &physical_device_props);
+        if (physical_device_props.apiVersion < VK_API_VERSION_1_3) {
+            continue;
+        }
+        VkPhysicalDeviceVulkan13Features vulkan_1_3_features {
+            .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_3_FEATURES
+        };
+        VkPhysicalDeviceFeatures2 features {
+            .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2,
+            .pNext = &vulkan_1_3_features
+        };
+        vkGetPhysicalDeviceFeatures2(physical_devices[i], &features);
+        if (!vulkan_1_3_features.synchronization2 || !vulkan_1_3_features.dynamicRendering) {
+            continue;
+        }
+
+        uint32_t num_queue_families;
+        vkGetPhysicalDeviceQueueFamilyProperties(physical_devices[i], &num_queue_families, nullptr);
+        const auto queue_family_props = std::make_unique_for_overwrite<VkQueueFamilyProperties[]>(num_queue_families);
+        vkGetPhysicalDeviceQueueFamilyProperties(physical_devices[i], &num_queue_families, queue_family_props.get());
+        for (uint32_t j = 0; j < num_queue_families; ++j) {
+            if (queue_family_props[j].queueFlags & VK_QUEUE_GRAPHICS_BIT) {
+                _physical_device = physical_devices[i];
+                _queue_family = j;
+                break;
+            }
+        }
+    }
+    if (!_physical_device) {
+        throw std::runtime_error("No vulkan 1.3 device with dynamic rendering and a graphics queue");
+    }
+
+    const float queue_priority = 1.0f;
+    const VkDeviceQueueCreateInfo queue_create_info {
+        .sType = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO,
+        .queueFamilyIndex = _queue_family,
+        .queueCount = 1,
+        .pQueuePriorities = &queue_priority
+    };
+    const VkPhysicalDeviceVulkan13Features desired_vulkan_1_3_features {
+        .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_3_FEATURES,
+        .synchronization2 = true,
+        .dynamicRendering = true
+    };
+    const VkDeviceCreateInfo device_create_info {
+        .sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO,
+        .pNext = &desired_vulkan_1_3_features,
+        .queueCreateInfoCount = 1,
+        .pQueueCreateInfos = &queue_create_info
+    };
+    check_success(vkCreateDevice(_physical_device, &device_create_info, nullptr, &_device));
+    volkLoadDevice(_device);
+
+    // One buffer stands in for the vertex, index, uniform and transform buffers
+    const VkBufferCreateInfo buffer_create_info {
+        .sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
+        .size = BUFFER_SIZE,
+        .usage = VK_BUFFER_USAGE_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+        .sharingMode = VK_SHARING_MODE_EXCLUSIVE
+    };
+    check_success(vkCreateBuffer(_device, &buffer_create_info, nullptr, &_buffer));
+    VkMemoryRequirements buffer_requirements;
+    vkGetBufferMemoryRequirements(_device, _buffer, &buffer_requirements);
+    check_success(vkBindBufferMemory(_device, _buffer, allocate(buffer_requirements), 0));
+
+    create_attachment(COLOR_FORMAT, VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT, VK_IMAGE_ASPECT_COLOR_BIT, 0);
+    create_attachment(DEPTH_FORMAT, VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT, VK_IMAGE_ASPECT_DEPTH_BIT, 1);
+
+    // Same layout as the renderer without GPU culling
+    const std::array descriptor_set_layout_bindings {
+        VkDescriptorSetLayoutBinding {
+            .binding = 0,
+            .descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC,
+            .descriptorCount = 1,
+            .stageFlags = VK_SHADER_STAGE_VERTEX_BIT,
+        },
+        VkDescriptorSetLayoutBinding {
+            .binding = 1,
+            .descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC,
+            .descriptorCount = 1,
+            .stageFlags = VK_SHADER_STAGE_VERTEX_BIT,
+        }
+    };
+    const VkDescriptorSetLayoutCreateInfo descriptor_set_layout_create_info {
+        .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO,
+        .bindingCount = descriptor_set_layout_bindings.size(),
+        .pBindings = descriptor_set_layout_bindings.data()
+    };
+    check_success(vkCreateDescriptorSetLayout(_device, &descriptor_set_layout_create_info, nullptr, &_descriptor_set_layout));
+
+    const VkPipelineLayoutCreateInfo pipeline_layout_create_info {
+        .sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO,
+        .setLayoutCount = 1,
+        .pSetLayouts = &_descriptor_set_layout
+    };
+    check_success(vkCreatePipelineLayout(_device, &pipeline_layout_create_info, nullptr, &_pipeline_layout));
+
+    const std::array descriptor_pool_sizes {
+        VkDescriptorPoolSize { VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC, 1 },
+        VkDescriptorPoolSize { VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC, 1 }
+    };
+    const VkDescriptorPoolCreateInfo descriptor_pool_create_info {
+        .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO,
+        .maxSets = 1,
+        .poolSizeCount = descriptor_pool_sizes.size(),
+        .pPoolSizes = descriptor_pool_sizes.data()
+    };
+    check_success(vkCreateDescriptorPool(_device, &descriptor_pool_create_info, nullptr, &_descriptor_pool));
+    const VkDescriptorSetAllocateInfo descriptor_set_allocate_info {
+        .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO,
+        .descriptorPool = _descriptor_pool,
+        .descriptorSetCount = 1,
+        .pSetLayouts = &_descriptor_set_layout
+    };
+    check_success(vkAllocateDescriptorSets(_device, &descriptor_set_allocate_info, &_descriptor_set));
+
+    const std::array descriptor_buffer_infos {
+        VkDescriptorBufferInfo { .buffer = _buffer, .offset = 0, .range = UNIFORMS_SIZE },
+        VkDescriptorBufferInfo { .buffer = _buffer, .offset = 0, .range = TRANSFORMS_SIZE }
+    };
+    const std::array descriptor_writes {
+        VkWriteDescriptorSet {
+            .sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+            .dstSet = _descriptor_set,
+            .dstBinding = 0,
+            .descriptorCount = 1,
+            .descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC,
+            .pBufferInfo = &descriptor_buffer_infos[0]
+        },
+        VkWriteDescriptorSet {
+            .sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+            .dstSet = _descriptor_set,
+            .dstBinding = 1,
+            .descriptorCount = 1,
+            .descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC,
+            .pBufferInfo = &descriptor_buffer_infos[1]
+        }
+    };
+    vkUpdateDescriptorSets(_device, descriptor_writes.size(), descriptor_writes.data(), 0, nullptr);
+
+    // The example's own shaders and fixed function state, so binding the pipeline costs the same
+    const auto vertex_code = load_shader("main.vert");
+    const auto fragment_code = load_shader("main.frag");
+    const std::array shader_module_create_infos {
+        VkShaderModuleCreateInfo {
+            .sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO,
+            .codeSize = vertex_code.size() * sizeof(uint32_t),
+            .pCode = vertex_code.data()
+        },
+        VkShaderModuleCreateInfo {
+            .sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO,
+            .codeSize = fragment_code.size() * sizeof(uint32_t),
+            .pCode = fragment_code.data()
+        }
+    };
+    std::array<VkShaderModule, 2> shader_modules;
+    check_success(vkCreateShaderModule(_device, &shader_module_create_infos[0], nullptr, &shader_modules[0]));
+    check_success(vkCreateShaderModule(_device, &shader_module_create_infos[1], nullptr, &shader_modules[1]));
+    const std::array pipeline_shader_stages {
+        VkPipelineShaderStageCreateInfo {
+            .sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
+            .stage = VK_SHADER_STAGE_VERTEX_BIT,
+            .module = shader_modules[0],
+            .pName = "main"
+        },
+        VkPipelineShaderStageCreateInfo {
+            .sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
+            .stage = VK_SHADER_STAGE_FRAGMENT_BIT,
+            .module = shader_modules[1],
+            .pName = "main"
+        }
+    };
+    const VkVertexInputBindingDescription vertex_binding_desc {
+        .binding = 0,
+        .stride = sizeof(Vertex),
+        .inputRate = VK_VERTEX_INPUT_RATE_VERTEX
+    };
+    const std::array vertex_attribute_descs {
+        VkVertexInputAttributeDescription {
+            .location = 0,
+            .binding = 0,
+            .format = VK_FORMAT_R32G32B32_SFLOAT,
+            .offset = offsetof(Vertex, position)
+        },
+        VkVertexInputAttributeDescription {
+            .location = 1,
+            .binding = 0,
+            .format = VK_FORMAT_R8G8B8A8_UNORM,
+            .offset = offsetof(Vertex, color)
+        }
+    };
+    const VkPipelineVertexInputStateCreateInfo pipeline_vertex_input_state {
+        .sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO,
+        .vertexBindingDescriptionCount = 1,
+        .pVertexBindingDescriptions = &vertex_binding_desc,
+        .vertexAttributeDescriptionCount = vertex_attribute_descs.size(),
+        .pVertexAttributeDescriptions = vertex_attribute_descs.data()
+    };
+    const VkPipelineInputAssemblyStateCreateInfo pipeline_input_assembly_state {
+        .sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO,
+        .topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST
+    };
+    const VkPipelineViewportStateCreateInfo pipeline_viewport_state {
+        .sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO,
+        .viewportCount = 1,
+        .scissorCount = 1
+    };
+    const VkPipelineRasterizationStateCreateInfo pipeline_raster_state {
+        .sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO,
+        .polygonMode = VK_POLYGON_MODE_FILL,
+        .cullMode = VK_CULL_MODE_BACK_BIT,
+        .lineWidth = 1.0f
+    };
+    const VkPipelineMultisampleStateCreateInfo pipeline_multisample_state {
+        .sType = VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO,
+        .rasterizationSamples = VK_SAMPLE_COUNT_1_BIT
+    };
+    const VkPipelineDepthStencilStateCreateInfo pipeline_depth_stencil_state {
+        .sType = VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO,
+        .depthTestEnable = true,
+        .depthWriteEnable = true,
+        .depthCompareOp = VK_COMPARE_OP_GREATER
+    };
+    const VkPipelineColorBlendAttachmentState pipeline_color_blend_attachment_state {
+        .colorWriteMask = VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT | VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT
+    };
+    const VkPipelineColorBlendStateCreateInfo pipeline_color_blend_state {
+        .sType = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO,
+        .attachmentCount = 1,
+        .pAttachments = &pipeline_color_blend_attachment_state
+    };
+    const std::array pipeline_dynamic_states = { VK_DYNAMIC_STATE_VIEWPORT, VK_DYNAMIC_STATE_SCISSOR };
+    const VkPipelineDynamicStateCreateInfo pipeline_dynamic_state {
+        .sType = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO,
+        .dynamicStateCount = pipeline_dynamic_states.size(),
+        .pDynamicStates = pipeline_dynamic_states.data()
+    };
+    const VkPipelineRenderingCreateInfo pipeline_rendering_create_info {
+        .sType = VK_STRUCTURE_TYPE_PIPELINE_RENDERING_CREATE_INFO,
+        .colorAttachmentCount = 1,
+        .pColorAttachmentFormats = &COLOR_FORMAT,
+        .depthAttachmentFormat = DEPTH_FORMAT
+    };
+    const VkGraphicsPipelineCreateInfo pipeline_create_info {
+        .sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO,
+        .pNext = &pipeline_rendering_create_info,
+        .stageCount = pipeline_shader_stages.size(),
+        .pStages = pipeline_shader_stages.data(),
+        .pVertexInputState = &pipeline_vertex_input_state,
+        .pInputAssemblyState = &pipeline_input_assembly_state,
+        .pViewportState = &pipeline_viewport_state,
+        .pRasterizationState = &pipeline_raster_state,
+        .pMultisampleState = &pipeline_multisample_state,
+        .pDepthStencilState = &pipeline_depth_stencil_state,
+        .pColorBlendState = &pipeline_color_blend_state,
+        .pDynamicState = &pipeline_dynamic_state,
+        .layout = _pipeline_layout
+    };
+    const auto pipeline_result = vkCreateGraphicsPipelines(_device, nullptr, 1, &pipeline_create_info, nullptr, &_pipeline);
+    for (const auto shader_module : shader_modules) {
+        vkDestroyShaderModule(_device, shader_module, nullptr);
+    }
+    check_success(pipeline_result);
+
+    const VkCommandPoolCreateInfo command_pool_create_info {
+        .sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO,
+        .flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT,
+        .queueFamilyIndex = _queue_family
+    };
+    check_success(vkCreateCommandPool(_device, &command_pool_create_info, nullptr, &_command_pool));
+    const VkCommandBufferAllocateInfo command_buffer_allocate_info {
+        .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO,
+        .commandPool = _command_pool,
+        .level = VK_COMMAND_BUFFER_LEVEL_PRIMARY,
+        .commandBufferCount = 1
+    };
+    check_success(vkAllocateCommandBuffers(_device, &command_buffer_allocate_info, &_command_buffer));
+}
+
+RecordingBenchmark::~RecordingBenchmark() {
+    if (_device) {
+        vkDestroyCommandPool(_device, _command_pool, nullptr);
+        vkDestroyPipeline(_device, _pipeline, nullptr);
+        vkDestroyDescriptorPool(_device, _descriptor_pool, nullptr);
+        vkDestroyPipelineLayout(_device, _pipeline_layout, nullptr);
+        vkDestroyDescriptorSetLayout(_device, _descriptor_set_layout, nullptr);
+        for (size_t i = 0; i < _images.size(); ++i) {
+            vkDestroyImageView(_device, _image_views[i], nullptr);
+            vkDestroyImage(_device, _images[i], nullptr);
+        }
+        vkDestroyBuffer(_device, _buffer, nullptr);
+        for (const auto memory : _memory) {
+            vkFreeMemory(_device, memory, nullptr);
+        }
+        vkDestroyDevice(_device, nullptr);
+    }
+    if (_instance) {
+        vkDestroyInstance(_instance, nullptr);
+    }
+}
+
+VkDevice RecordingBenchmark::device() noexcept {
+    return _device;
+}
+
+uint32_t RecordingBenchmark::queue_family() const noexcept {
+    return _queue_family;
+}
+
+void RecordingBenchmark::record(JobSystem& jobs, RecordingWorkers& workers, uint32_t draw_count) {
+    const std::array dynamic_offsets { 0u, 0u };
+    const VkDeviceSize null_offset = 0;
+    const VkRect2D scissor = { {}, TARGET_SIZE };
+    const VkViewport viewport {
+        .x = 0, .y = static_cast<float>(TARGET_SIZE.height),
+        .width = static_cast<float>(TARGET_SIZE.width), .height = -static_cast<float>(TARGET_SIZE.height),
+        .minDepth = 0.0f, .maxDepth = 1.0f
+    };
+    // Matches the draws recorded by Renderer::record_command_buffer() without culling
+    const auto record_draws = [&](VkCommandBuffer draw_cb, uint32_t, uint32_t count) {
+        vkCmdBindDescriptorSets(draw_cb, VK_PIPELINE_BIND_POINT_GRAPHICS, _pipeline_layout, 0, 1, &_descriptor_set, dynamic_offsets.size(), dynamic_offsets.data());
+        vkCmdBindPipeline(draw_cb, VK_PIPELINE_BIND_POINT_GRAPHICS, _pipeline);
+        vkCmdBindIndexBuffer(draw_cb, _buffer, null_offset, VK_INDEX_TYPE_UINT16);
+        vkCmdBindVertexBuffers(draw_cb, 0, 1, &_buffer, &null_offset);
+        vkCmdSetScissor(draw_cb, 0, 1, &scissor);
+        vkCmdSetViewport(draw_cb, 0, 1, &viewport);
+        for (uint32_t i = 0; i < count; ++i) {
+            vkCmdDrawIndexed(draw_cb, 3, 1, 0, 0, 0);
+        }
+    };
+
+    const bool use_secondaries = workers.num_slices() > 0;
+    const std::vector<VkCommandBuffer> *secondaries = nullptr;
+    if (use_secondaries) {
+        const VkCommandBufferInheritanceRenderingInfo inheritance_rendering_info {
+            .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_RENDERING_INFO,
+            .colorAttachmentCount = 1,
+            .pColorAttachmentFormats = &COLOR_FORMAT,
+            .depthAttachmentFormat = DEPTH_FORMAT,
+            .rasterizationSamples = VK_SAMPLE_COUNT_1_BIT
+        };
+        secondaries = &workers.record(jobs, 0, inheritance_rendering_info, draw_count, record_draws);
+    }
+
+    const VkRenderingAttachmentInfo color_attachment_info {
+        .sType = VK_STRUCTURE_TYPE_RENDERING_ATTACHMENT_INFO,
+        .imageView = _image_views[0],
+        .imageLayout = VK_IMAGE_LAYOUT_ATTACHMENT_OPTIMAL,
+        .loadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE,
+        .storeOp = VK_ATTACHMENT_STORE_OP_DONT_CARE
+    };
+    const VkRenderingAttachmentInfo depth_attachment_info {
+        .sType = VK_STRUCTURE_TYPE_RENDERING_ATTACHMENT_INFO,
+        .imageView = _image_views[1],
+        .imageLayout = VK_IMAGE_LAYOUT_ATTACHMENT_OPTIMAL,
+        .loadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE,
+        .storeOp = VK_ATTACHMENT_STORE_OP_DONT_CARE
+    };
+    const VkRenderingInfo rendering_info {
+        .sType = VK_STRUCTURE_TYPE_RENDERING_INFO,
+        .flags = use_secondaries ? VK_RENDERING_CONTENTS_SECONDARY_COMMAND_BUFFERS_BIT : VkRenderingFlags{0},
+        .renderArea = { {0, 0}, TARGET_SIZE },
+        .layerCount = 1,
+        .colorAttachmentCount = 1,
+        .pColorAttachments = &color_attachment_info,
+        .pDepthAttachment = &depth_attachment_info
+    };
+    const VkCommandBufferBeginInfo command_buffer_begin_info {
+        .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
+        .flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT
+    };
+
+    check_success(vkResetCommandPool(_device, _command_pool, 0));
+    check_success(vkBeginCommandBuffer(_command_buffer, &command_buffer_begin_info));
+    vkCmdBeginRendering(_command_buffer, &rendering_info);
+    if (secondaries) {
+        vkCmdExecuteCommands(_command_buffer, static_cast<uint32_t>(secondaries->size()), secondaries->data());
+    } else {
+        record_draws(_command_buffer, 0, draw_count);
+    }
+    vkCmdEndRendering(_command_buffer);
+    check_success(vkEndCommandBuffer(_command_buffer));
+}
+
+VkDeviceMemory RecordingBenchmark::allocate(const VkMemoryRequirements& requirements) {
+    VkPhysicalDeviceMemoryProperties memory_props;
+    vkGetPhysicalDeviceMemoryProperties(_physical_device, &memory_props);
+
+    // The contents are never read, any memory type the resource supports will do
+    uint32_t memory_type = UINT32_MAX;
+    for (uint32_t i = 0; i < memory_props.memoryTypeCount && UINT32_MAX == memory_type; ++i) {
+        if (requirements.memoryTypeBits & (1u << i)) {
+            memory_type = i;
+        }
+    }
+    if (UINT32_MAX == memory_type) {
+        throw std::runtime_error("No memory type for benchmark resources");
+    }
+
+    const VkMemoryAllocateInfo memory_allocate_info {
+        .sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO,
+        .allocationSize = requirements.size,
+        .memoryTypeIndex = memory_type
+    };
+    VkDeviceMemory ret;
+    check_success(vkAllocateMemory(_device, &memory_allocate_info, nullptr, &ret));
+    _memory.push_back(ret);
+    return ret;
+}
+
+void RecordingBenchmark::create_attachment(VkFormat format, VkImageUsageFlags usage, VkImageAspectFlags aspect, size_t index) {
+    const VkImageCreateInfo image_create_info {
+        .sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO,
+        .imageType = VK_IMAGE_TYPE_2D,
+        .format = format,
+        .extent = { TARGET_SIZE.width, TARGET_SIZE.height, 1 },
+        .mipLevels = 1,
+        .arrayLayers = 1,
+        .samples = VK_SAMPLE_COUNT_1_BIT,
+        .tiling = VK_IMAGE_TILING_OPTIMAL,
+        .usage = usage,
+        .sharingMode = VK_SHARING_MODE_EXCLUSIVE,
+        .initialLayout = VK_IMAGE_LAYOUT_UNDEFINED
+    };
+    check_success(vkCreateImage(_device, &image_create_info, nullptr, &_images[index]));
+    VkMemoryRequirements requirements;
+    vkGetImageMemoryRequirements(_device, _images[index], &requirements);
+    check_success(vkBindImageMemory(_device, _images[index], allocate(requirements), 0));
+
+    const VkImageViewCreateInfo image_view_create_info {
+        .sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO,
+        .image = _images[index],
+        .viewType = VK_IMAGE_VIEW_TYPE_2D,
+        .format = format,
+        .subresourceRange = { aspect, 0, 1, 0, 1 }
+    };
+    check_success(vkCreateImageView(_device, &image_view_create_info, nullptr, &_image_views[index]));
+}
+
+// Times recording a frame of increasing numbers of draws straight into the primary command buffer
+// and split between increasing numbers of secondary command buffers on the job system, and prints
+// how each scales against the primary command buffer alone
+int main() {
+    RecordingBenchmark benchmark;
+    JobSystem jobs(std::max(std::thread::hardware_concurrency(), 1u) - 1);
+
+    std::printf("Recording on %zu threads:\n", jobs.num_threads());
+    for (const auto draw_count : BENCHMARK_DRAW_COUNTS) {
+        std::printf("%u draws:\n", draw_count);
+        double primary_ms = 0.0;
+        for (const auto num_slices : BENCHMARK_SLICES) {
+            RecordingWorkers workers;
+            workers.init(benchmark.device(), benchmark.queue_family(), 1, num_slices);
+            const auto ms = fastest_run_ms([&] {
+                benchmark.record(jobs, workers, draw_count);
+            });
+            workers.destroy();
+
+            if (!num_slices) {
+                primary_ms = ms;
+            }
+            const auto name = num_slices ? std::to_string(num_slices) + " slices" : "primary"s;
+            std::printf("  %-10s %8.3fms %7.2fns/draw %5.2fx\n", name.c_str(), ms, ms * 1e6 / draw_count, primary_ms / ms);
+        }
+    }
+    return 0;
+}
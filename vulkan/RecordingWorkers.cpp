@@ -0,0 +1,104 @@
+#include "RecordingWorkers.hpp"
+
+#include "Common.hpp"
+
+#include <volk.h>
+
+#include <algorithm>
+
+RecordingWorkers::RecordingWorkers()
+    :_device(nullptr)
+{}
+
+void RecordingWorkers::destroy() noexcept {
+    for (const auto& slice_data : _slice_data) {
+        for (const auto command_pool : slice_data.command_pools) {
+            vkDestroyCommandPool(_device, command_pool, nullptr);
+        }
+    }
+    _slice_data.clear();
+}
+
+void RecordingWorkers::init(VkDevice device, uint32_t queue_family, size_t num_frames, size_t num_slices) {
+    _device = device;
+
+    _slice_data.resize(num_slices);
+    for (auto& slice_data : _slice_data) {
+        slice_data.command_pools.resize(num_frames);
+        slice_data.command_buffers.resize(num_frames);
+        for (size_t i = 0; i < num_frames; ++i) {
+            const VkCommandPoolCreateInfo command_pool_create_info {
+                .sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO,
+                .flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT,
+                .queueFamilyIndex = queue_family
+            };
+            check_success(vkCreateCommandPool(_device, &command_pool_create_info, nullptr, &slice_data.command_pools[i]));
+
+            const VkCommandBufferAllocateInfo command_buffer_allocate_info {
+                .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO,
+                .commandPool = slice_data.command_pools[i],
+                .level = VK_COMMAND_BUFFER_LEVEL_SECONDARY,
+                .commandBufferCount = 1
+            };
+            check_success(vkAllocateCommandBuffers(_device, &command_buffer_allocate_info, &slice_data.command_buffers[i]));
+        }
+        slice_data.recorded_count = 0;
+    }
+}
+
+size_t RecordingWorkers::num_slices() const noexcept {
+    return _slice_data.size();
+}
+
+const std::vector<VkCommandBuffer>& RecordingWorkers::record(
+    JobSystem& jobs, size_t frame_index, const VkCommandBufferInheritanceRenderingInfo& inheritance_rendering_info,
+    uint32_t count, const RecordFunction& record_function
+) {
+    JobCounter counter;
+    for (size_t i = 0; i < _slice_data.size(); ++i) {
+        jobs.submit([&, i]() {
+            record_slice(i, frame_index, inheritance_rendering_info, count, record_function);
+        }, counter);
+    }
+    jobs.wait(counter);
+
+    _recorded.clear();
+    for (const auto& slice_data : _slice_data) {
+        if (slice_data.recorded_count) {
+            _recorded.push_back(slice_data.command_buffers[frame_index]);
+        }
+    }
+    return _recorded;
+}
+
+void RecordingWorkers::record_slice(
+    size_t slice_index, size_t frame_index, const VkCommandBufferInheritanceRenderingInfo& inheritance_rendering_info,
+    uint32_t count, const RecordFunction& record_function
+) {
+    auto& slice_data = _slice_data[slice_index];
+
+    // The first count % num_slices slices take one extra draw
+    const auto num_slices = static_cast<uint32_t>(_slice_data.size());
+    const auto index = static_cast<uint32_t>(slice_index);
+    const auto first = index * (count / num_slices) + std::min(index, count % num_slices);
+    slice_data.recorded_count = count / num_slices + (index < count % num_slices ? 1 : 0);
+    if (!slice_data.recorded_count) {
+        return;
+    }
+
+    check_success(vkResetCommandPool(_device, slice_data.command_pools[frame_index], 0));
+
+    const VkCommandBufferInheritanceInfo inheritance_info {
+        .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO,
+        .pNext = &inheritance_rendering_info
+    };
+    const VkCommandBufferBeginInfo command_buffer_begin_info {
+        .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
+        .flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT | VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT,
+        .pInheritanceInfo = &inheritance_info
+    };
+    const auto cb = slice_data.command_buffers[frame_index];
+    check_success(vkBeginCommandBuffer(cb, &command_buffer_begin_info));
+    record_function(cb, first, slice_data.recorded_count);
+    check_success(vkEndCommandBuffer(cb));
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+#include "JobSystem.hpp"
+
+#include <vulkan/vulkan.h>
+
+#include <functional>
+#include <vector>
+
+// Records slices of a frame's draws into secondary command buffers, one job per slice. Every
+// slice owns a command pool per frame in flight, so recording never shares a pool between threads.
+class RecordingWorkers {
+public:
+    // Records draws [first, first + count) into a secondary command buffer that has already been begun
+    using RecordFunction = std::function<void(VkCommandBuffer command_buffer, uint32_t first, uint32_t count)>;
+
+    RecordingWorkers();
+    RecordingWorkers(const RecordingWorkers&) = delete;
+    RecordingWorkers(RecordingWorkers&&) noexcept = delete;
+    ~RecordingWorkers() = default;
+
+    RecordingWorkers& operator=(const RecordingWorkers&) = delete;
+    RecordingWorkers& operator=(RecordingWorkers&&) noexcept = delete;
+
+    void destroy() noexcept;
+
+    void init(VkDevice device, uint32_t queue_family, size_t num_frames, size_t num_slices);
+
+    size_t num_slices() const noexcept;
+
+    // Splits count draws evenly between the slices, records them on the job system and blocks until
+    // all of them are done. The frame's previous command buffers must no longer be in use. Returns
+    // the non-empty command buffers in draw order, ready for vkCmdExecuteCommands.
+    const std::vector<VkCommandBuffer>& record(
+        JobSystem& jobs, size_t frame_index, const VkCommandBufferInheritanceRenderingInfo& inheritance_rendering_info,
+        uint32_t count, const RecordFunction& record_function
+    );
+
+private:
+    struct SliceData {
+        std::vector<VkCommandPool> command_pools;
+        std::vector<VkCommandBuffer> command_buffers;
+        uint32_t recorded_count;
+    };
+
+    void record_slice(
+        size_t slice_index, size_t frame_index, const VkCommandBufferInheritanceRenderingInfo& inheritance_rendering_info,
+        uint32_t count, const RecordFunction& record_function
+    );
+
+private:
+    VkDevice _device;
+    std::vector<SliceData> _slice_data;
+
+    std::vector<VkCommandBuffer> _recorded;
+};
@@ -1,6 +1,9 @@
 #include "Renderer.hpp"
 
 #include "Common.hpp"
+#include "Environment.hpp"
+#include "scene/Frustum.hpp"
+#include "scene/Scene.hpp"
 #include "wayland/Window.hpp"
 
 #include <glm/gtc/reciprocal.hpp>
@@ -8,9 +11,14 @@
 #include <glm/gtx/transform.hpp>
 #include <volk.h>
 
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
 #include <cstring>
 #include <filesystem>
 #include <fstream>
+#include <thread>
 #include <utility>
 
 using namespace std::literals;
@@ -21,17 +29,34 @@ struct PhysicalDeviceInformation {
     uint32_t graphics_queue, compute_queue, transfer_queue;
 
     bool graphics_queue_supports_presentation;
+    bool has_calibrated_timestamps;
+    bool has_draw_indirect_count;
+    bool has_dynamic_rendering;
     bool has_memory_priority;
     bool has_pageable_device_local_memory;
     bool has_maintenance_5;
+    bool has_present_wait;
+    bool has_swapchain_maintenance_1;
     bool has_synchronization_2;
 };
 
 struct MatrixUniforms {
-    glm::mat4 modelview;
+    glm::mat4 view;
     glm::mat4 projection;
 };
 
+struct CullConstants {
+    std::array<glm::vec4, 6> frustum_planes;
+    uint32_t num_instances;
+    float bounding_radius;
+};
+
+// Start of every draw buffer region, matching DRAW in cull.comp. The visible instance ids follow it.
+struct CulledDraw {
+    uint32_t draw_count;
+    VkDrawIndexedIndirectCommand command;
+};
+
 struct Vertex {
     std::array<float, 3> position;
     std::array<uint8_t, 4> color;
@@ -44,6 +69,26 @@ static const std::array REQUIRED_INSTANCE_EXTENSIONS {
     VK_KHR_WAYLAND_SURFACE_EXTENSION_NAME
 };
 
+// Staging space for uploads in flight on the transfer queue, larger uploads are split
+static constexpr VkDeviceSize STAGING_RING_CAPACITY = 16 * 1024 * 1024;
+
+static constexpr long MAX_RECORDING_SLICES = 16;
+static constexpr long MAX_JOB_WORKERS = 64;
+
+// Every hardware thread but the one rendering, which joins in whenever it waits on jobs
+static size_t default_job_workers() noexcept {
+    return std::max(std::thread::hardware_concurrency(), 1u) - 1;
+}
+
+// Per-frame space for uniforms and other data written by the CPU every frame, on top of the instance transforms
+static constexpr VkDeviceSize FRAME_ALLOCATOR_CAPACITY = 256 * 1024;
+
+// Upper bound on how long the latency limiter blocks, so a surface that stops being shown can't hang rendering
+static constexpr uint64_t LATENCY_LIMIT_TIMEOUT_NS = 100'000'000;
+
+// Must match local_size_x in cull.comp
+static constexpr uint32_t CULL_WORKGROUP_SIZE = 64;
+
 static constexpr float FIELD_OF_VIEW = glm::radians(90.0f);
 static constexpr float NEAR_CLIP_PLANE = 0.01f;
 
@@ -56,6 +101,18 @@ static constexpr std::array<Vertex, 3> VERTICES {{
     {{1.0f,  1.5f, 0.0f}, {   0,   0, 255, 255 }},
 }};
 
+static constexpr VkDeviceSize align_up(VkDeviceSize value, VkDeviceSize alignment) noexcept {
+    return (value + alignment - 1) / alignment * alignment;
+}
+
+static float mesh_bounding_radius() noexcept {
+    float ret = 0.0f;
+    for (const auto& vertex : VERTICES) {
+        ret = std::max(ret, glm::length(glm::vec3(vertex.position[0], vertex.position[1], vertex.position[2])));
+    }
+    return ret;
+}
+
 static std::partial_ordering operator<=>(const VkExtent2D& extent, const std::pair<uint32_t, uint32_t>& pair) noexcept {
     const std::weak_ordering width_comparison = extent.width <=> pair.first;
     const std::weak_ordering height_comparison = extent.height <=> pair.second;
@@ -145,20 +202,32 @@ static std::vector<PhysicalDeviceInformation> get_physical_device_info(VkInstanc
         const auto device_extension_properties = std::make_unique_for_overwrite<VkExtensionProperties[]>(num_device_extensions);
         check_success(vkEnumerateDeviceExtensionProperties(physical_device, nullptr, &num_device_extensions, device_extension_properties.get()));
 
+        bool has_ext_calibrated_timestamps = false;
         bool has_ext_memory_priority = false;
         bool has_ext_pageable_device_local_memory = false;
         bool has_khr_maintenance_5 = false;
+        bool has_khr_present_id = false;
+        bool has_khr_present_wait = false;
         bool has_khr_swapchain = false;
+        bool has_ext_swapchain_maintenance_1 = false;
         for (uint32_t j = 0; j < num_device_extensions; ++j) {
             const auto extension_name = device_extension_properties[j].extensionName;
-            if (!strcmp(extension_name, VK_EXT_MEMORY_PRIORITY_EXTENSION_NAME)) {
+            if (!strcmp(extension_name, VK_EXT_CALIBRATED_TIMESTAMPS_EXTENSION_NAME)) {
+                has_ext_calibrated_timestamps = true;
+            } else if (!strcmp(extension_name, VK_EXT_MEMORY_PRIORITY_EXTENSION_NAME)) {
                 has_ext_memory_priority = true;
             } else if (!strcmp(extension_name, VK_EXT_PAGEABLE_DEVICE_LOCAL_MEMORY_EXTENSION_NAME)) {
                 has_ext_pageable_device_local_memory = true;
             } else if (!strcmp(extension_name, VK_KHR_MAINTENANCE_5_EXTENSION_NAME)) {
                 has_khr_maintenance_5 = true;
+            } else if (!strcmp(extension_name, VK_KHR_PRESENT_ID_EXTENSION_NAME)) {
+                has_khr_present_id = true;
+            } else if (!strcmp(extension_name, VK_KHR_PRESENT_WAIT_EXTENSION_NAME)) {
+                has_khr_present_wait = true;
             } else if (!strcmp(extension_name, VK_KHR_SWAPCHAIN_EXTENSION_NAME)) {
                 has_khr_swapchain = true;
+            } else if (!strcmp(extension_name, VK_EXT_SWAPCHAIN_MAINTENANCE_1_EXTENSION_NAME)) {
+                has_ext_swapchain_maintenance_1 = true;
             }
         }
 
@@ -191,9 +260,31 @@ static std::vector<PhysicalDeviceInformation> get_physical_device_info(VkInstanc
             maintenance_5_features.pNext = std::exchange(optional_pnext_chain, &maintenance_5_features);
         }
 
+        VkPhysicalDevicePresentIdFeaturesKHR present_id_features = {
+            .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PRESENT_ID_FEATURES_KHR,
+        };
+        VkPhysicalDevicePresentWaitFeaturesKHR present_wait_features = {
+            .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PRESENT_WAIT_FEATURES_KHR,
+        };
+        if (has_khr_present_id && has_khr_present_wait) {
+            present_id_features.pNext = std::exchange(optional_pnext_chain, &present_id_features);
+            present_wait_features.pNext = std::exchange(optional_pnext_chain, &present_wait_features);
+        }
+
+        VkPhysicalDeviceSwapchainMaintenance1FeaturesEXT swapchain_maintenance_1_features = {
+            .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_SWAPCHAIN_MAINTENANCE_1_FEATURES_EXT,
+        };
+        if (has_ext_swapchain_maintenance_1) {
+            swapchain_maintenance_1_features.pNext = std::exchange(optional_pnext_chain, &swapchain_maintenance_1_features);
+        }
+
+        VkPhysicalDeviceVulkan12Features vulkan_1_2_features {
+            .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES,
+            .pNext = optional_pnext_chain
+        };
         VkPhysicalDeviceVulkan13Features vulkan_1_3_features {
             .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_3_FEATURES,
-            .pNext = optional_pnext_chain  
+            .pNext = &vulkan_1_2_features
         };
         VkPhysicalDeviceFeatures2 physical_device_features {
             .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2,
@@ -201,9 +292,14 @@ static std::vector<PhysicalDeviceInformation> get_physical_device_info(VkInstanc
         };
         vkGetPhysicalDeviceFeatures2(physical_device, &physical_device_features);
 
+        device_info.has_calibrated_timestamps = has_ext_calibrated_timestamps;
         device_info.has_memory_priority = memory_priority_features.memoryPriority;
         device_info.has_pageable_device_local_memory = pagable_device_local_memory_features.pageableDeviceLocalMemory;
         device_info.has_maintenance_5 = maintenance_5_features.maintenance5;
+        device_info.has_present_wait = present_id_features.presentId && present_wait_features.presentWait;
+        device_info.has_swapchain_maintenance_1 = swapchain_maintenance_1_features.swapchainMaintenance1;
+        device_info.has_draw_indirect_count = vulkan_1_2_features.drawIndirectCount;
+        device_info.has_dynamic_rendering = vulkan_1_3_features.dynamicRendering;
         device_info.has_synchronization_2 = vulkan_1_3_features.synchronization2;
     }
 
@@ -219,6 +315,9 @@ static PhysicalDeviceInformation select_physical_device(
         if (device_info.vulkan_version < VK_API_VERSION_1_3) {
             is_valid = false;
         }
+        if (!device_info.has_dynamic_rendering) {
+            is_valid = false;
+        }
         if (!device_info.has_maintenance_5) {
             is_valid = false;
         }
@@ -238,7 +337,15 @@ static PhysicalDeviceInformation select_physical_device(
 
 Renderer::Renderer(Window& window)
     :_window(window)
+    ,_job_system(static_cast<size_t>(std::clamp(get_env_integer("WAYLAND_EXAMPLE_JOB_THREADS", static_cast<long>(default_job_workers() + 1)), 1L, MAX_JOB_WORKERS + 1) - 1))
+    ,_scene(static_cast<uint32_t>(std::clamp(get_env_integer("WAYLAND_EXAMPLE_INSTANCE_COUNT", 1), 1L, static_cast<long>(MAX_SCENE_INSTANCES))), mesh_bounding_radius())
+    ,_start_time(std::chrono::steady_clock::now())
+    ,_compute_overlap{}
+    ,_recording_statistics{}
+    ,_draw_buffer_stride(0)
+    ,_num_culled_frames(0)
 {
+    const auto startup_begin = std::chrono::steady_clock::now();
     check_success(volkInitialize());
 
     uint32_t supported_api_version;
@@ -290,10 +397,20 @@ Renderer::Renderer(Window& window)
     _physical_device = physical_device_info.physical_device;
     _queue_family_index = physical_device_info.graphics_queue;
 
+    _culling_mode = parse_culling_mode(get_env_string("WAYLAND_EXAMPLE_CULLING")).value_or(CullingMode::None);
+    if (_culling_mode == CullingMode::Gpu && !physical_device_info.has_draw_indirect_count) {
+        std::fprintf(stderr, "GPU culling requires drawIndirectCount, drawing every instance instead\n");
+        _culling_mode = CullingMode::None;
+    }
+
     std::vector device_extensions{
         VK_KHR_MAINTENANCE_5_EXTENSION_NAME,
         VK_KHR_SWAPCHAIN_EXTENSION_NAME
     };
+    // Relates timestamps of the graphics and compute queues, for the async compute overlap report
+    if (physical_device_info.has_calibrated_timestamps) {
+        device_extensions.emplace_back(VK_EXT_CALIBRATED_TIMESTAMPS_EXTENSION_NAME);
+    }
     void *optional_pnext_chain = nullptr;
 
     VkPhysicalDevicePageableDeviceLocalMemoryFeaturesEXT desired_pageable_memory_features {
@@ -312,28 +429,75 @@ Renderer::Renderer(Window& window)
         desired_memory_priority_features.memoryPriority = true;
         desired_memory_priority_features.pNext = std::exchange(optional_pnext_chain, &desired_memory_priority_features);
     }
+    VkPhysicalDevicePresentIdFeaturesKHR desired_present_id_features {
+        .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PRESENT_ID_FEATURES_KHR,
+    };
+    VkPhysicalDevicePresentWaitFeaturesKHR desired_present_wait_features {
+        .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PRESENT_WAIT_FEATURES_KHR,
+    };
+    if (physical_device_info.has_present_wait) {
+        device_extensions.emplace_back(VK_KHR_PRESENT_ID_EXTENSION_NAME);
+        device_extensions.emplace_back(VK_KHR_PRESENT_WAIT_EXTENSION_NAME);
+        desired_present_id_features.presentId = true;
+        desired_present_id_features.pNext = std::exchange(optional_pnext_chain, &desired_present_id_features);
+        desired_present_wait_features.presentWait = true;
+        desired_present_wait_features.pNext = std::exchange(optional_pnext_chain, &desired_present_wait_features);
+    }
+    VkPhysicalDeviceSwapchainMaintenance1FeaturesEXT desired_swapchain_maintenance_1_features {
+        .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_SWAPCHAIN_MAINTENANCE_1_FEATURES_EXT,
+    };
+    if (physical_device_info.has_swapchain_maintenance_1) {
+        device_extensions.emplace_back(VK_EXT_SWAPCHAIN_MAINTENANCE_1_EXTENSION_NAME);
+        desired_swapchain_maintenance_1_features.swapchainMaintenance1 = true;
+        desired_swapchain_maintenance_1_features.pNext = std::exchange(optional_pnext_chain, &desired_swapchain_maintenance_1_features);
+    }
     const VkPhysicalDeviceMaintenance5FeaturesKHR desired_maintenance_5_features {
         .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MAINTENANCE_5_FEATURES_KHR,
         .pNext = optional_pnext_chain,
         .maintenance5 = true
     };
+    const VkPhysicalDeviceVulkan12Features desired_vulkan_1_2_features {
+        .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES,
+        .pNext = const_cast<VkPhysicalDeviceMaintenance5FeaturesKHR *>(&desired_maintenance_5_features),
+        .drawIndirectCount = _culling_mode == CullingMode::Gpu,
+        .timelineSemaphore = true
+    };
     const VkPhysicalDeviceVulkan13Features desired_vulkan_1_3_features {
         .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_3_FEATURES,
-        .pNext = const_cast<VkPhysicalDeviceMaintenance5FeaturesKHR *>(&desired_maintenance_5_features),
-        .synchronization2 = true
+        .pNext = const_cast<VkPhysicalDeviceVulkan12Features *>(&desired_vulkan_1_2_features),
+        .synchronization2 = true,
+        .dynamicRendering = true
     };
     const float queue_priority = 1.0f;
-    const VkDeviceQueueCreateInfo queue_create_info {
-        .sType = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO,
-        .queueFamilyIndex = _queue_family_index,
-        .queueCount = 1,
-        .pQueuePriorities = &queue_priority
+    std::vector<VkDeviceQueueCreateInfo> queue_create_infos {
+        VkDeviceQueueCreateInfo {
+            .sType = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO,
+            .queueFamilyIndex = _queue_family_index,
+            .queueCount = 1,
+            .pQueuePriorities = &queue_priority
+        }
     };
+    if (UINT32_MAX != physical_device_info.compute_queue) {
+        queue_create_infos.push_back({
+            .sType = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO,
+            .queueFamilyIndex = physical_device_info.compute_queue,
+            .queueCount = 1,
+            .pQueuePriorities = &queue_priority
+        });
+    }
+    if (UINT32_MAX != physical_device_info.transfer_queue) {
+        queue_create_infos.push_back({
+            .sType = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO,
+            .queueFamilyIndex = physical_device_info.transfer_queue,
+            .queueCount = 1,
+            .pQueuePriorities = &queue_priority
+        });
+    }
     const VkDeviceCreateInfo device_create_info {
         .sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO,
         .pNext = &desired_vulkan_1_3_features,
-        .queueCreateInfoCount = 1,
-        .pQueueCreateInfos = &queue_create_info,
+        .queueCreateInfoCount = static_cast<uint32_t>(queue_create_infos.size()),
+        .pQueueCreateInfos = queue_create_infos.data(),
         .enabledExtensionCount = static_cast<uint32_t>(device_extensions.size()),
         .ppEnabledExtensionNames = device_extensions.data()
     };
@@ -355,20 +519,63 @@ Renderer::Renderer(Window& window)
         .vulkanApiVersion = application_info.apiVersion
     };
     check_success(vmaCreateAllocator(&allocator_create_info, &d.allocator));
-    _swapchain.init(d.device, d.allocator, d.surface, _physical_device);
+    _pipeline_cache.init(d.device, _physical_device);
+    _swapchain.init(d.device, d.allocator, d.surface, _physical_device, physical_device_info.has_swapchain_maintenance_1, physical_device_info.has_present_wait);
+    _max_queued_frames = static_cast<uint32_t>(std::max(0L, get_env_integer("WAYLAND_EXAMPLE_MAX_QUEUED_FRAMES", 0)));
+    if (physical_device_info.has_present_wait) {
+        _present_waiter.start(d.device);
+    }
+    _draw_count = static_cast<uint32_t>(std::max(1L, get_env_integer("WAYLAND_EXAMPLE_DRAW_COUNT", 1)));
+    const auto num_frames_in_flight = std::clamp(get_env_integer("WAYLAND_EXAMPLE_FRAMES_IN_FLIGHT", DEFAULT_FRAMES_IN_FLIGHT), 1L, static_cast<long>(MAX_FRAMES_IN_FLIGHT));
+    d.frame_data.resize(static_cast<size_t>(num_frames_in_flight));
 
     vkGetDeviceQueue(d.device, _queue_family_index, 0, &_queue);
 
-    const VkDescriptorSetLayoutBinding descriptor_set_layout_binding {
-        .binding = 0,
-        .descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC,
-        .descriptorCount = 1,
-        .stageFlags = VK_SHADER_STAGE_VERTEX_BIT,
+    if (UINT32_MAX != physical_device_info.compute_queue) {
+        VkQueue compute_queue;
+        vkGetDeviceQueue(d.device, physical_device_info.compute_queue, 0, &compute_queue);
+        _compute_queue.init(d.device, _physical_device, compute_queue, physical_device_info.compute_queue, _queue_family_index, d.frame_data.size());
+    } else {
+        _compute_queue.init(d.device, _physical_device, _queue, _queue_family_index, _queue_family_index, d.frame_data.size());
+    }
+    _graphics_timestamps.init(d.device, _physical_device, _queue_family_index, d.frame_data.size());
+    _timestamp_calibration.init(d.device, _physical_device, physical_device_info.has_calibrated_timestamps);
+    _recording_workers.init(d.device, _queue_family_index, d.frame_data.size(),
+        static_cast<size_t>(std::clamp(get_env_integer("WAYLAND_EXAMPLE_RECORDING_SLICES", 0), 0L, MAX_RECORDING_SLICES)));
+
+    if (UINT32_MAX != physical_device_info.transfer_queue) {
+        VkQueue transfer_queue;
+        vkGetDeviceQueue(d.device, physical_device_info.transfer_queue, 0, &transfer_queue);
+        _upload_manager.init(d.device, d.allocator, STAGING_RING_CAPACITY, transfer_queue, physical_device_info.transfer_queue, _queue_family_index);
+    } else {
+        _upload_manager.init(d.device, d.allocator, STAGING_RING_CAPACITY, _queue, _queue_family_index, _queue_family_index);
+    }
+
+    const std::array descriptor_set_layout_bindings {
+        VkDescriptorSetLayoutBinding {
+            .binding = 0,
+            .descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC,
+            .descriptorCount = 1,
+            .stageFlags = VK_SHADER_STAGE_VERTEX_BIT,
+        },
+        VkDescriptorSetLayoutBinding {
+            .binding = 1,
+            .descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC,
+            .descriptorCount = 1,
+            .stageFlags = VK_SHADER_STAGE_VERTEX_BIT,
+        },
+        // Visible instance ids written by GPU culling, only used with it
+        VkDescriptorSetLayoutBinding {
+            .binding = 2,
+            .descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC,
+            .descriptorCount = 1,
+            .stageFlags = VK_SHADER_STAGE_VERTEX_BIT,
+        }
     };
     const VkDescriptorSetLayoutCreateInfo descriptor_set_layout_create_info {
         .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO,
-        .bindingCount = 1,
-        .pBindings = &descriptor_set_layout_binding
+        .bindingCount = _culling_mode == CullingMode::Gpu ? 3u : 2u,
+        .pBindings = descriptor_set_layout_bindings.data()
     };
     check_success(vkCreateDescriptorSetLayout(d.device, &descriptor_set_layout_create_info, nullptr, &d.descriptor_set_layout));
 
@@ -379,69 +586,7 @@ Renderer::Renderer(Window& window)
     };
     check_success(vkCreatePipelineLayout(d.device, &pipeline_layout_create_info, nullptr, &d.pipeline_layout));
 
-    const std::array attachment_descs {
-        VkAttachmentDescription {
-            .format = _swapchain.format(),
-            .samples = VK_SAMPLE_COUNT_1_BIT,
-            .loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR,
-            .storeOp = VK_ATTACHMENT_STORE_OP_STORE,
-            .initialLayout = VK_IMAGE_LAYOUT_UNDEFINED,
-            .finalLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR
-        },
-        VkAttachmentDescription {
-            .format = _swapchain.depth_format(),
-            .samples = VK_SAMPLE_COUNT_1_BIT,
-            .loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR,
-            .storeOp = VK_ATTACHMENT_STORE_OP_DONT_CARE,
-            .initialLayout = VK_IMAGE_LAYOUT_UNDEFINED,
-            .finalLayout = VK_IMAGE_LAYOUT_ATTACHMENT_OPTIMAL
-        }
-    };
-    const VkAttachmentReference color_attachment_ref {
-        .attachment = 0,
-        .layout = VK_IMAGE_LAYOUT_ATTACHMENT_OPTIMAL
-    };
-    const VkAttachmentReference depth_attachment_ref {
-        .attachment = 1,
-        .layout = VK_IMAGE_LAYOUT_ATTACHMENT_OPTIMAL
-    };
-    const VkSubpassDescription subpass_desc {
-        .colorAttachmentCount = 1,
-        .pColorAttachments = &color_attachment_ref,
-        .pDepthStencilAttachment = &depth_attachment_ref
-    };
-    const std::array subpass_dependencies {
-        VkSubpassDependency {
-            .srcSubpass = VK_SUBPASS_EXTERNAL,
-            .dstSubpass = 0,
-            .srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
-            .dstStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
-            .srcAccessMask = VK_ACCESS_NONE,
-            .dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT,
-            .dependencyFlags = VK_DEPENDENCY_BY_REGION_BIT
-        },
-        VkSubpassDependency {
-            .srcSubpass = VK_SUBPASS_EXTERNAL,
-            .dstSubpass = 0,
-            .srcStageMask = VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT,
-            .dstStageMask = VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT,
-            .srcAccessMask = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT,
-            .dstAccessMask = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT,
-            .dependencyFlags = VK_DEPENDENCY_BY_REGION_BIT
-        }
-    };
-    const VkRenderPassCreateInfo render_pass_create_info {
-        .sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO,
-        .attachmentCount = attachment_descs.size(),
-        .pAttachments = attachment_descs.data(),
-        .subpassCount = 1,
-        .pSubpasses = &subpass_desc,
-        .dependencyCount = subpass_dependencies.size(),
-        .pDependencies = subpass_dependencies.data()
-    };
-    check_success(vkCreateRenderPass(d.device, &render_pass_create_info, nullptr, &d.render_pass));
-
-    const std::vector<uint32_t> vertex_code = load_shader("main.vert");
+    const std::vector<uint32_t> vertex_code = load_shader(_culling_mode == CullingMode::Gpu ? "culled.vert" : "main.vert");
     const VkShaderModuleCreateInfo vertex_shader_create_info {
         .sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO,
         .codeSize = vertex_code.size() * sizeof(uint32_t),
@@ -534,8 +679,16 @@ Renderer::Renderer(Window& window)
         .dynamicStateCount = pipeline_dynamic_states.size(),
         .pDynamicStates = pipeline_dynamic_states.data()
     };
+    const auto color_format = _swapchain.format();
+    const VkPipelineRenderingCreateInfo pipeline_rendering_create_info {
+        .sType = VK_STRUCTURE_TYPE_PIPELINE_RENDERING_CREATE_INFO,
+        .colorAttachmentCount = 1,
+        .pColorAttachmentFormats = &color_format,
+        .depthAttachmentFormat = _swapchain.depth_format()
+    };
     const VkGraphicsPipelineCreateInfo pipeline_create_info {
         .sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO,
+        .pNext = &pipeline_rendering_create_info,
         .stageCount = pipeline_shader_stages.size(),
         .pStages = pipeline_shader_stages.data(),
         .pVertexInputState = &pipeline_vertex_input_state,
@@ -546,17 +699,20 @@ Renderer::Renderer(Window& window)
         .pDepthStencilState = &pipeline_depth_stencil_state,
         .pColorBlendState = &pipeline_color_blend_state,
         .pDynamicState = &pipeline_dynamic_state,
-        .layout = d.pipeline_layout,
-        .renderPass = d.render_pass
+        .layout = d.pipeline_layout
     };
-    check_success(vkCreateGraphicsPipelines(d.device, nullptr, 1, &pipeline_create_info, nullptr, &d.pipeline)); // FIXME: PipelineCache
+    const auto pipeline_begin = std::chrono::steady_clock::now();
+    check_success(vkCreateGraphicsPipelines(d.device, _pipeline_cache.handle(), 1, &pipeline_create_info, nullptr, &d.pipeline));
+    const auto pipeline_end = std::chrono::steady_clock::now();
 
+    // Room for the culling set as well
     const std::array descriptor_pool_sizes {
-        VkDescriptorPoolSize { VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC, 1 }
+        VkDescriptorPoolSize { VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC, 1 },
+        VkDescriptorPoolSize { VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC, 6 }
     };
     const VkDescriptorPoolCreateInfo descriptor_pool_create_info {
         .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO,
-        .maxSets = 1,
+        .maxSets = 2,
         .poolSizeCount = descriptor_pool_sizes.size(),
         .pPoolSizes = descriptor_pool_sizes.data()
     };
@@ -572,57 +728,67 @@ Renderer::Renderer(Window& window)
     const VkBufferCreateInfo index_buffer_create_info {
         .sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
         .size = sizeof(INDICES),
-        .usage = VK_BUFFER_USAGE_INDEX_BUFFER_BIT
+        .usage = VK_BUFFER_USAGE_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT
     };
-    const VmaAllocationCreateInfo staging_allocation_info {
-        .flags = VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT, // FIXME: Change to staging-instead bit
+    const VmaAllocationCreateInfo device_local_allocation_info {
         .usage = VMA_MEMORY_USAGE_AUTO_PREFER_DEVICE,
         .priority = HIGH_PRIORITY
     };
-    vmaCreateBuffer(d.allocator, &index_buffer_create_info, &staging_allocation_info, &d.index_buffer, &d.index_allocation, nullptr);
-
-    void *pData;
-    vmaMapMemory(d.allocator, d.index_allocation, &pData);
-    memcpy(pData, &INDICES, sizeof(INDICES));
-    vmaUnmapMemory(d.allocator, d.index_allocation);
+    check_success(vmaCreateBuffer(d.allocator, &index_buffer_create_info, &device_local_allocation_info, &d.index_buffer, &d.index_allocation, nullptr));
+    _upload_manager.upload_buffer(d.index_buffer, 0, INDICES.data(), sizeof(INDICES));
 
     const VkBufferCreateInfo vertex_buffer_create_info {
         .sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
         .size = sizeof(VERTICES),
-        .usage = VK_BUFFER_USAGE_VERTEX_BUFFER_BIT
+        .usage = VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT
     };
-    vmaCreateBuffer(d.allocator, &vertex_buffer_create_info, &staging_allocation_info, &d.vertex_buffer, &d.vertex_allocation, nullptr);
-    
-    vmaMapMemory(d.allocator, d.vertex_allocation, &pData);
-    memcpy(pData, &VERTICES, sizeof(VERTICES));
-    vmaUnmapMemory(d.allocator, d.vertex_allocation);
+    check_success(vmaCreateBuffer(d.allocator, &vertex_buffer_create_info, &device_local_allocation_info, &d.vertex_buffer, &d.vertex_allocation, nullptr));
+    _upload_manager.upload_buffer(d.vertex_buffer, 0, VERTICES.data(), sizeof(VERTICES));
+    _upload_manager.flush();
+
+    const VkDeviceSize instance_transforms_size = _scene.num_instances() * sizeof(glm::mat4);
+    // Instance transforms are read by the culling shader on the compute queue
+    std::vector shared_queue_families { _queue_family_index };
+    if (_culling_mode == CullingMode::Gpu && _compute_queue.is_async()) {
+        shared_queue_families.push_back(_compute_queue.queue_family());
+    }
+    _frame_allocator.init(d.allocator, _physical_device, d.frame_data.size(), FRAME_ALLOCATOR_CAPACITY + instance_transforms_size, shared_queue_families);
 
-    const VkBufferCreateInfo uniform_buffer_create_info {
-        .sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
-        .size = NUM_FRAMES_IN_FLIGHT * sizeof(MatrixUniforms),
-        .usage = VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT
+    const std::array descriptor_buffer_infos {
+        VkDescriptorBufferInfo {
+            .buffer = _frame_allocator.buffer(),
+            .offset = 0,
+            .range = sizeof(MatrixUniforms)
+        },
+        VkDescriptorBufferInfo {
+            .buffer = _frame_allocator.buffer(),
+            .offset = 0,
+            .range = instance_transforms_size
+        }
     };
-    const VmaAllocationCreateInfo mappable_allocation_info {
-        .flags = VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT | VMA_ALLOCATION_CREATE_MAPPED_BIT,
-        .usage = VMA_MEMORY_USAGE_AUTO_PREFER_DEVICE,
-        .priority = NORMAL_PRIORITY
+    const std::array descriptor_writes {
+        VkWriteDescriptorSet {
+            .sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+            .dstSet = d.descriptor_set,
+            .dstBinding = 0,
+            .descriptorCount = 1,
+            .descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC,
+            .pBufferInfo = &descriptor_buffer_infos[0]
+        },
+        VkWriteDescriptorSet {
+            .sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+            .dstSet = d.descriptor_set,
+            .dstBinding = 1,
+            .descriptorCount = 1,
+            .descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC,
+            .pBufferInfo = &descriptor_buffer_infos[1]
+        }
     };
-    vmaCreateBuffer(d.allocator, &uniform_buffer_create_info, &mappable_allocation_info, &d.uniform_buffer, &d.uniform_allocation, nullptr);
+    vkUpdateDescriptorSets(d.device, descriptor_writes.size(), descriptor_writes.data(), 0, nullptr);
 
-    const VkDescriptorBufferInfo descriptor_buffer_info {
-        .buffer = d.uniform_buffer,
-        .offset = 0,
-        .range = sizeof(MatrixUniforms)
-    };
-    const VkWriteDescriptorSet descriptor_write {
-        .sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
-        .dstSet = d.descriptor_set,
-        .dstBinding = 0,
-        .descriptorCount = 1,
-        .descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC,
-        .pBufferInfo = &descriptor_buffer_info
-    };
-    vkUpdateDescriptorSets(d.device, 1, &descriptor_write, 0, nullptr);
+    if (_culling_mode == CullingMode::Gpu) {
+        init_gpu_culling(shared_queue_families);
+    }
 
     for (auto& frame_data : d.frame_data) {
         const VkCommandPoolCreateInfo command_pool_create_info {
@@ -640,24 +806,37 @@ Renderer::Renderer(Window& window)
         };
         check_success(vkAllocateCommandBuffers(d.device, &command_buffer_allocate_info, &frame_data.command_buffer));
 
-        const VkFenceCreateInfo signalled_fence_create_info {
-            .sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO,
-            .flags = VK_FENCE_CREATE_SIGNALED_BIT
-        };
-        check_success(vkCreateFence(d.device, &signalled_fence_create_info, nullptr, &frame_data.fence));
-
         const VkSemaphoreCreateInfo semaphore_create_info {
             .sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO
         };
         check_success(vkCreateSemaphore(d.device, &semaphore_create_info, nullptr, &frame_data.semaphore));
     }
     _frame_index = d.frame_data.size();
+
+    const VkSemaphoreTypeCreateInfo timeline_type_create_info {
+        .sType = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO,
+        .semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE,
+        .initialValue = 0
+    };
+    const VkSemaphoreCreateInfo timeline_create_info {
+        .sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO,
+        .pNext = &timeline_type_create_info
+    };
+    check_success(vkCreateSemaphore(d.device, &timeline_create_info, nullptr, &d.frame_timeline));
+    _frame_number = 0;
+
+    const std::chrono::duration<double, std::milli> pipeline_time = pipeline_end - pipeline_begin;
+    const std::chrono::duration<double, std::milli> startup_time = std::chrono::steady_clock::now() - startup_begin;
+    std::printf("Renderer startup: %.2fms (pipelines: %.2fms, %s pipeline cache)\n",
+        startup_time.count(), pipeline_time.count(), _pipeline_cache.is_warm() ? "warm" : "cold");
 }
 
 Renderer::~Renderer() {
     if (d.device) {
-        vkQueueWaitIdle(_queue); // This can be reduced with EXT_swapchain_maintenance1
-        _swapchain.destroy(true);
+        vkQueueWaitIdle(_queue);
+        _present_waiter.stop();
+        _swapchain.destroy();
+        _pipeline_cache.save();
     }
 }
 
@@ -665,53 +844,479 @@ FrameData& Renderer::frame() noexcept {
     return d.frame_data[_frame_index];
 }
 
+uint64_t Renderer::completed_frames() const {
+    uint64_t value;
+    check_success(vkGetSemaphoreCounterValue(d.device, d.frame_timeline, &value));
+    return value;
+}
+
+uint64_t Renderer::submitted_frames() const noexcept {
+    return _frame_number;
+}
+
+bool Renderer::wait_for_frame(uint64_t frame_number, uint64_t timeout_ns) const {
+    const VkSemaphoreWaitInfo wait_info {
+        .sType = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO,
+        .semaphoreCount = 1,
+        .pSemaphores = &d.frame_timeline,
+        .pValues = &frame_number
+    };
+    const auto result = vkWaitSemaphores(d.device, &wait_info, timeout_ns);
+    if (VK_TIMEOUT == result) {
+        return false;
+    }
+    check_success(result);
+    return true;
+}
+
+size_t Renderer::frames_in_flight() const noexcept {
+    return d.frame_data.size();
+}
+
+size_t Renderer::num_draw_regions() const noexcept {
+    // The frame being culled and the one being drawn both need a region on top of the frames in flight
+    return d.frame_data.size() + 1;
+}
+
+FrameAllocatorStatistics Renderer::frame_allocator_statistics() const noexcept {
+    return _frame_allocator.statistics();
+}
+
+ComputeOverlapStatistics Renderer::compute_overlap_statistics() const noexcept {
+    if (!_compute_overlap.num_frames) {
+        return { .num_submitted_frames = _compute_queue.num_submitted() };
+    }
+    return {
+        .num_submitted_frames = _compute_queue.num_submitted(),
+        .num_frames = _compute_overlap.num_frames,
+        .compute_ms = _compute_overlap.compute_ms / _compute_overlap.num_frames,
+        .graphics_ms = _compute_overlap.graphics_ms / _compute_overlap.num_frames,
+        .overlap_ms = _compute_overlap.overlap_ms / _compute_overlap.num_frames
+    };
+}
+
+RecordingStatistics Renderer::recording_statistics() const noexcept {
+    auto ret = _recording_statistics;
+    ret.draw_count = _draw_count;
+    ret.num_slices = _recording_workers.num_slices();
+    ret.num_threads = _job_system.num_threads();
+    if (ret.num_frames) {
+        ret.average_ms /= ret.num_frames;
+    }
+    return ret;
+}
+
+TransformStatistics Renderer::transform_statistics() const noexcept {
+    auto ret = _scene.transform_statistics();
+    ret.num_threads = _job_system.num_threads();
+    return ret;
+}
+
+CullingStatistics Renderer::culling_statistics() const noexcept {
+    return _scene.culling_statistics();
+}
+
+LatencyStatistics Renderer::present_latency_statistics() const {
+    return _present_waiter.latency_statistics();
+}
+
 void Renderer::render() {
+    _swapchain.set_present_policy(_window.present_policy());
     if (_swapchain.rebuild_required() || _window.buffer_size() != _swapchain.size()) {
-        vkQueueWaitIdle(_queue); // This can be reduced with EXT_swapchain_maintenance1
-        _swapchain.rebuild(_window.buffer_size(), d.render_pass);
+        if (_swapchain.rebuild_requires_idle()) {
+            vkQueueWaitIdle(_queue);
+        }
+        // The waiter must be done with the swapchain before it is retired
+        _present_waiter.drop_pending();
+        _swapchain.rebuild(_window.buffer_size());
     }
+    wait_for_presents();
 
     _frame_index = (_frame_index + 1) % d.frame_data.size();
-    check_success(vkWaitForFences(d.device, 1, &frame().fence, true, UINT64_MAX));
+    wait_for_frame(frame().timeline_value);
+    _compute_queue.wait_for_frame(_frame_index);
+    collect_compute_overlap();
     if (_swapchain.acquire(frame().semaphore)) {
-        record_command_buffer();
-
-        const VkPipelineStageFlags wait_stage_mask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
-        const VkSubmitInfo submit_info {
-            .sType = VK_STRUCTURE_TYPE_SUBMIT_INFO,
-            .waitSemaphoreCount = 1,
-            .pWaitSemaphores = &frame().semaphore,
-            .pWaitDstStageMask = &wait_stage_mask,
-            .commandBufferCount = 1,
-            .pCommandBuffers = &frame().command_buffer,
-            .signalSemaphoreCount = 1,
-            .pSignalSemaphores = &_swapchain.image_data().semaphore
+        const auto pending_acquire = _upload_manager.take_pending_acquire();
+        record_command_buffer(pending_acquire.barriers);
+
+        frame().timeline_value = ++_frame_number;
+        const std::array wait_semaphore_infos {
+            VkSemaphoreSubmitInfo {
+                .sType = VK_STRUCTURE_TYPE_SEMAPHORE_SUBMIT_INFO,
+                .semaphore = frame().semaphore,
+                .stageMask = VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT
+            },
+            // Waiting on an already reached value is free, so there is no need to skip these without new work
+            VkSemaphoreSubmitInfo {
+                .sType = VK_STRUCTURE_TYPE_SEMAPHORE_SUBMIT_INFO,
+                .semaphore = _upload_manager.timeline(),
+                .value = pending_acquire.timeline_value,
+                .stageMask = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT
+            },
+            VkSemaphoreSubmitInfo {
+                .sType = VK_STRUCTURE_TYPE_SEMAPHORE_SUBMIT_INFO,
+                .semaphore = _compute_queue.timeline(),
+                .value = _compute_queue.graphics_wait(),
+                .stageMask = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT
+            }
+        };
+        const VkCommandBufferSubmitInfo command_buffer_info {
+            .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_SUBMIT_INFO,
+            .commandBuffer = frame().command_buffer
+        };
+        const std::array signal_semaphore_infos {
+            VkSemaphoreSubmitInfo {
+                .sType = VK_STRUCTURE_TYPE_SEMAPHORE_SUBMIT_INFO,
+                .semaphore = _swapchain.image_data().semaphore,
+                .stageMask = VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT
+            },
+            VkSemaphoreSubmitInfo {
+                .sType = VK_STRUCTURE_TYPE_SEMAPHORE_SUBMIT_INFO,
+                .semaphore = d.frame_timeline,
+                .value = frame().timeline_value,
+                .stageMask = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT
+            }
+        };
+        const VkSubmitInfo2 submit_info {
+            .sType = VK_STRUCTURE_TYPE_SUBMIT_INFO_2,
+            .waitSemaphoreInfoCount = wait_semaphore_infos.size(),
+            .pWaitSemaphoreInfos = wait_semaphore_infos.data(),
+            .commandBufferInfoCount = 1,
+            .pCommandBufferInfos = &command_buffer_info,
+            .signalSemaphoreInfoCount = signal_semaphore_infos.size(),
+            .pSignalSemaphoreInfos = signal_semaphore_infos.data()
         };
-        check_success(vkResetFences(d.device, 1, &frame().fence));
-        check_success(vkQueueSubmit(_queue, 1, &submit_info, frame().fence));
+        check_success(vkQueueSubmit2(_queue, 1, &submit_info, nullptr));
+        _compute_queue.end_frame();
+
+        _window.begin_frame();
+        if (_swapchain.present(_queue)) {
+            if (_swapchain.has_present_wait()) {
+                _present_waiter.submitted(_swapchain.handle(), _swapchain.last_present_id());
+            }
+        } else {
+            _window.cancel_frame();
+        }
+    }
+
+    if (_swapchain.rebuild_required()) {
+        _window.request_frame();
+    }
+}
+
+void Renderer::collect_compute_overlap() {
+    // Both spans are converted to the host clock, which is only meaningful right after calibrating
+    _timestamp_calibration.calibrate();
+    const auto compute_span = _compute_queue.take_span(_frame_index, _timestamp_calibration);
+    const auto graphics_span = _graphics_timestamps.take_span(_frame_index, _timestamp_calibration);
+    if (!compute_span || !graphics_span) {
+        return;
+    }
+
+    ++_compute_overlap.num_frames;
+    _compute_overlap.compute_ms += compute_span->end_ms - compute_span->begin_ms;
+    _compute_overlap.graphics_ms += graphics_span->end_ms - graphics_span->begin_ms;
+    _compute_overlap.overlap_ms += std::max(0.0,
+        std::min(compute_span->end_ms, graphics_span->end_ms) - std::max(compute_span->begin_ms, graphics_span->begin_ms));
+}
+
+void Renderer::init_gpu_culling(std::span<const uint32_t> queue_families) {
+    VkPhysicalDeviceProperties physical_device_props;
+    vkGetPhysicalDeviceProperties(_physical_device, &physical_device_props);
+
+    // Every instance may be visible, so each region has room for every instance id after its draw.
+    // The ids are bound on their own, so they start at a storage buffer offset alignment.
+    const auto alignment = physical_device_props.limits.minStorageBufferOffsetAlignment;
+    const auto visible_instances_offset = align_up(sizeof(CulledDraw), alignment);
+    const auto visible_instances_size = _scene.num_instances() * sizeof(uint32_t);
+    _draw_buffer_stride = align_up(visible_instances_offset + visible_instances_size, alignment);
+    const VkBufferCreateInfo draw_buffer_create_info {
+        .sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
+        .size = num_draw_regions() * _draw_buffer_stride,
+        .usage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+        .sharingMode = queue_families.size() > 1 ? VK_SHARING_MODE_CONCURRENT : VK_SHARING_MODE_EXCLUSIVE,
+        .queueFamilyIndexCount = queue_families.size() > 1 ? static_cast<uint32_t>(queue_families.size()) : 0,
+        .pQueueFamilyIndices = queue_families.data()
+    };
+    const VmaAllocationCreateInfo draw_allocation_create_info {
+        .usage = VMA_MEMORY_USAGE_AUTO_PREFER_DEVICE,
+        .priority = HIGH_PRIORITY
+    };
+    check_success(vmaCreateBuffer(d.allocator, &draw_buffer_create_info, &draw_allocation_create_info, &d.draw_buffer, &d.draw_allocation, nullptr));
+
+    const std::array descriptor_set_layout_bindings {
+        VkDescriptorSetLayoutBinding {
+            .binding = 0,
+            .descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC,
+            .descriptorCount = 1,
+            .stageFlags = VK_SHADER_STAGE_COMPUTE_BIT,
+        },
+        VkDescriptorSetLayoutBinding {
+            .binding = 1,
+            .descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC,
+            .descriptorCount = 1,
+            .stageFlags = VK_SHADER_STAGE_COMPUTE_BIT,
+        },
+        VkDescriptorSetLayoutBinding {
+            .binding = 2,
+            .descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC,
+            .descriptorCount = 1,
+            .stageFlags = VK_SHADER_STAGE_COMPUTE_BIT,
+        }
+    };
+    const VkDescriptorSetLayoutCreateInfo descriptor_set_layout_create_info {
+        .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO,
+        .bindingCount = descriptor_set_layout_bindings.size(),
+        .pBindings = descriptor_set_layout_bindings.data()
+    };
+    check_success(vkCreateDescriptorSetLayout(d.device, &descriptor_set_layout_create_info, nullptr, &d.cull_descriptor_set_layout));
+
+    const VkPushConstantRange push_constant_range {
+        .stageFlags = VK_SHADER_STAGE_COMPUTE_BIT,
+        .offset = 0,
+        .size = sizeof(CullConstants)
+    };
+    const VkPipelineLayoutCreateInfo pipeline_layout_create_info {
+        .sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO,
+        .setLayoutCount = 1,
+        .pSetLayouts = &d.cull_descriptor_set_layout,
+        .pushConstantRangeCount = 1,
+        .pPushConstantRanges = &push_constant_range
+    };
+    check_success(vkCreatePipelineLayout(d.device, &pipeline_layout_create_info, nullptr, &d.cull_pipeline_layout));
+
+    const std::vector<uint32_t> compute_code = load_shader("cull.comp");
+    const VkShaderModuleCreateInfo compute_shader_create_info {
+        .sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO,
+        .codeSize = compute_code.size() * sizeof(uint32_t),
+        .pCode = compute_code.data()
+    };
+    const VkComputePipelineCreateInfo pipeline_create_info {
+        .sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO,
+        .stage = {
+            .sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
+            .pNext = &compute_shader_create_info,
+            .stage = VK_SHADER_STAGE_COMPUTE_BIT,
+            .pName = "main"
+        },
+        .layout = d.cull_pipeline_layout
+    };
+    check_success(vkCreateComputePipelines(d.device, _pipeline_cache.handle(), 1, &pipeline_create_info, nullptr, &d.cull_pipeline));
 
-        _swapchain.present(_queue);
+    const VkDescriptorSetAllocateInfo descriptor_set_allocate_info {
+        .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO,
+        .descriptorPool = d.descriptor_pool,
+        .descriptorSetCount = 1,
+        .pSetLayouts = &d.cull_descriptor_set_layout
+    };
+    check_success(vkAllocateDescriptorSets(d.device, &descriptor_set_allocate_info, &d.cull_descriptor_set));
+
+    const std::array descriptor_buffer_infos {
+        VkDescriptorBufferInfo {
+            .buffer = _frame_allocator.buffer(),
+            .offset = 0,
+            .range = _scene.num_instances() * sizeof(glm::mat4)
+        },
+        VkDescriptorBufferInfo {
+            .buffer = d.draw_buffer,
+            .offset = 0,
+            .range = sizeof(CulledDraw)
+        },
+        VkDescriptorBufferInfo {
+            .buffer = d.draw_buffer,
+            .offset = visible_instances_offset,
+            .range = visible_instances_size
+        }
+    };
+    // The graphics set reads the compacted ids from the same region
+    const std::array descriptor_writes {
+        VkWriteDescriptorSet {
+            .sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+            .dstSet = d.cull_descriptor_set,
+            .dstBinding = 0,
+            .descriptorCount = 1,
+            .descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC,
+            .pBufferInfo = &descriptor_buffer_infos[0]
+        },
+        VkWriteDescriptorSet {
+            .sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+            .dstSet = d.cull_descriptor_set,
+            .dstBinding = 1,
+            .descriptorCount = 1,
+            .descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC,
+            .pBufferInfo = &descriptor_buffer_infos[1]
+        },
+        VkWriteDescriptorSet {
+            .sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+            .dstSet = d.cull_descriptor_set,
+            .dstBinding = 2,
+            .descriptorCount = 1,
+            .descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC,
+            .pBufferInfo = &descriptor_buffer_infos[2]
+        },
+        VkWriteDescriptorSet {
+            .sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+            .dstSet = d.descriptor_set,
+            .dstBinding = 2,
+            .descriptorCount = 1,
+            .descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC,
+            .pBufferInfo = &descriptor_buffer_infos[2]
+        }
+    };
+    vkUpdateDescriptorSets(d.device, descriptor_writes.size(), descriptor_writes.data(), 0, nullptr);
+}
+
+void Renderer::record_culling(const glm::mat4& view_projection, uint32_t instance_transforms_offset, VkDeviceSize draws_offset) {
+    const CullConstants cull_constants {
+        .frustum_planes = Frustum::from_view_projection(view_projection).planes,
+        .num_instances = _scene.num_instances(),
+        .bounding_radius = mesh_bounding_radius()
+    };
+    const std::array dynamic_offsets {
+        instance_transforms_offset,
+        static_cast<uint32_t>(draws_offset),
+        static_cast<uint32_t>(draws_offset)
+    };
+    // Nothing is drawn until the first visible instance sets the draw count
+    const CulledDraw cleared_draw {
+        .draw_count = 0,
+        .command = {
+            .indexCount = INDICES.size(),
+            .instanceCount = 0,
+            .firstIndex = 0,
+            .vertexOffset = 0,
+            .firstInstance = 0
+        }
+    };
+
+    // The previous contents were last read by a graphics submission that has already been waited for
+    const VkMemoryBarrier2 clear_barrier {
+        .sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER_2,
+        .srcStageMask = VK_PIPELINE_STAGE_2_COPY_BIT,
+        .srcAccessMask = VK_ACCESS_2_TRANSFER_WRITE_BIT,
+        .dstStageMask = VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT,
+        .dstAccessMask = VK_ACCESS_2_SHADER_STORAGE_READ_BIT | VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT
+    };
+    const VkDependencyInfo clear_dependency_info {
+        .sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO,
+        .memoryBarrierCount = 1,
+        .pMemoryBarriers = &clear_barrier
+    };
+
+    // The next frame's graphics submission waits on the compute timeline, which makes the draws visible to it
+    const auto cb = _compute_queue.begin(_frame_index);
+    vkCmdUpdateBuffer(cb, d.draw_buffer, draws_offset, sizeof(CulledDraw), &cleared_draw);
+    vkCmdPipelineBarrier2(cb, &clear_dependency_info);
+    vkCmdBindPipeline(cb, VK_PIPELINE_BIND_POINT_COMPUTE, d.cull_pipeline);
+    vkCmdBindDescriptorSets(cb, VK_PIPELINE_BIND_POINT_COMPUTE, d.cull_pipeline_layout, 0, 1, &d.cull_descriptor_set, dynamic_offsets.size(), dynamic_offsets.data());
+    vkCmdPushConstants(cb, d.cull_pipeline_layout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(CullConstants), &cull_constants);
+    vkCmdDispatch(cb, (_scene.num_instances() + CULL_WORKGROUP_SIZE - 1) / CULL_WORKGROUP_SIZE, 1, 1);
+    _compute_queue.submit();
+}
+
+void Renderer::wait_for_presents() {
+    if (!_swapchain.has_present_wait() || !_max_queued_frames) {
+        return;
     }
+
+    // Once the allowed number of frames are queued, sleep until the oldest reaches the screen so
+    // that this frame's inputs are sampled later
+    _present_waiter.wait_for_pending(_max_queued_frames, std::chrono::nanoseconds(LATENCY_LIMIT_TIMEOUT_NS));
 }
 
-void Renderer::record_command_buffer() {
+void Renderer::record_command_buffer(const std::vector<VkBufferMemoryBarrier2>& acquire_barriers) {
     const VkCommandBufferBeginInfo command_buffer_begin_info {
         .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
         .flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT
     };
 
     const auto swapchain_size = _swapchain.size();
-    const std::array clear_values {
-        VkClearValue { .color = { .float32 = {0.0f, 0.0f, 0.0f, 0.0f} } },
-        VkClearValue { .depthStencil = { .depth = 0.0f } }
-    };
-    const VkRenderPassBeginInfo render_pass_begin_info {
-        .sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO,
-        .renderPass = d.render_pass,
-        .framebuffer = _swapchain.image_data().framebuffer,
+    const auto& image_data = _swapchain.image_data();
+
+    // Neither attachment's previous contents are needed, so both start out UNDEFINED. The color
+    // barrier chains with the acquire semaphore wait, the depth one with the previous frame's writes.
+    const std::array begin_image_barriers {
+        VkImageMemoryBarrier2 {
+            .sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2,
+            .srcStageMask = VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT,
+            .srcAccessMask = VK_ACCESS_2_NONE,
+            .dstStageMask = VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT,
+            .dstAccessMask = VK_ACCESS_2_COLOR_ATTACHMENT_WRITE_BIT,
+            .oldLayout = VK_IMAGE_LAYOUT_UNDEFINED,
+            .newLayout = VK_IMAGE_LAYOUT_ATTACHMENT_OPTIMAL,
+            .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+            .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+            .image = image_data.image,
+            .subresourceRange = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1 }
+        },
+        VkImageMemoryBarrier2 {
+            .sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2,
+            .srcStageMask = VK_PIPELINE_STAGE_2_LATE_FRAGMENT_TESTS_BIT,
+            .srcAccessMask = VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT,
+            .dstStageMask = VK_PIPELINE_STAGE_2_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_2_LATE_FRAGMENT_TESTS_BIT,
+            .dstAccessMask = VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT,
+            .oldLayout = VK_IMAGE_LAYOUT_UNDEFINED,
+            .newLayout = VK_IMAGE_LAYOUT_ATTACHMENT_OPTIMAL,
+            .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+            .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+            .image = _swapchain.depth_image(),
+            .subresourceRange = { VK_IMAGE_ASPECT_DEPTH_BIT, 0, 1, 0, 1 }
+        }
+    };
+    const VkDependencyInfo begin_dependency_info {
+        .sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO,
+        .bufferMemoryBarrierCount = static_cast<uint32_t>(acquire_barriers.size()),
+        .pBufferMemoryBarriers = acquire_barriers.data(),
+        .imageMemoryBarrierCount = begin_image_barriers.size(),
+        .pImageMemoryBarriers = begin_image_barriers.data()
+    };
+
+    const VkRenderingAttachmentInfo color_attachment_info {
+        .sType = VK_STRUCTURE_TYPE_RENDERING_ATTACHMENT_INFO,
+        .imageView = image_data.image_view,
+        .imageLayout = VK_IMAGE_LAYOUT_ATTACHMENT_OPTIMAL,
+        .loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR,
+        .storeOp = VK_ATTACHMENT_STORE_OP_STORE,
+        .clearValue = { .color = { .float32 = {0.0f, 0.0f, 0.0f, 0.0f} } }
+    };
+    const VkRenderingAttachmentInfo depth_attachment_info {
+        .sType = VK_STRUCTURE_TYPE_RENDERING_ATTACHMENT_INFO,
+        .imageView = _swapchain.depth_view(),
+        .imageLayout = VK_IMAGE_LAYOUT_ATTACHMENT_OPTIMAL,
+        .loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR,
+        .storeOp = VK_ATTACHMENT_STORE_OP_DONT_CARE,
+        .clearValue = { .depthStencil = { .depth = 0.0f } }
+    };
+    const bool use_secondaries = _recording_workers.num_slices() > 0;
+    const VkRenderingInfo rendering_info {
+        .sType = VK_STRUCTURE_TYPE_RENDERING_INFO,
+        .flags = use_secondaries ? VK_RENDERING_CONTENTS_SECONDARY_COMMAND_BUFFERS_BIT : VkRenderingFlags{0},
         .renderArea = { {0, 0}, swapchain_size },
-        .clearValueCount = clear_values.size(),
-        .pClearValues = clear_values.data()
+        .layerCount = 1,
+        .colorAttachmentCount = 1,
+        .pColorAttachments = &color_attachment_info,
+        .pDepthAttachment = &depth_attachment_info
+    };
+
+    // Chains with the render finished semaphore, which is signalled at the same stage
+    const VkImageMemoryBarrier2 present_barrier {
+        .sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2,
+        .srcStageMask = VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT,
+        .srcAccessMask = VK_ACCESS_2_COLOR_ATTACHMENT_WRITE_BIT,
+        .dstStageMask = VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT,
+        .dstAccessMask = VK_ACCESS_2_NONE,
+        .oldLayout = VK_IMAGE_LAYOUT_ATTACHMENT_OPTIMAL,
+        .newLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR,
+        .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+        .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+        .image = image_data.image,
+        .subresourceRange = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1 }
+    };
+    const VkDependencyInfo end_dependency_info {
+        .sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO,
+        .imageMemoryBarrierCount = 1,
+        .pImageMemoryBarriers = &present_barrier
     };
 
     const VkRect2D scissor = { {}, swapchain_size };
@@ -722,33 +1327,104 @@ void Renderer::record_command_buffer() {
     };
 
     const VkDeviceSize null_offset = 0;
-    const auto matrix_uniforms_offset = static_cast<uint32_t>(_frame_index * sizeof(MatrixUniforms));
 
-    const auto model = glm::translate(glm::vec3(-1.0f, -0.75f, 0.0f));
     const auto view = glm::lookAt(glm::vec3(0.0, 0.0, -2.0), glm::vec3(0.0, 0.0, 0.0), glm::vec3(0.0, 1.0, 0.0));
     const auto aspect = static_cast<float>(swapchain_size.width) / static_cast<float>(swapchain_size.height);
     const MatrixUniforms matrix_uniforms {
-        .modelview = view * model,
+        .view = view,
         .projection = infinitePerspectiveFovReverse(FIELD_OF_VIEW, aspect, NEAR_CLIP_PLANE)
     };
 
-    void *pData;
-    vmaMapMemory(d.allocator, d.uniform_allocation, &pData);
-    memcpy(&reinterpret_cast<MatrixUniforms *>(pData)[_frame_index], &matrix_uniforms, sizeof(MatrixUniforms));
-    vmaUnmapMemory(d.allocator, d.uniform_allocation);
+    _frame_allocator.begin_frame(_frame_index);
+    const auto matrix_uniforms_allocation = _frame_allocator.allocate(sizeof(MatrixUniforms));
+    // Cache line aligned for the streaming stores of the transform kernels
+    const auto instance_transforms_allocation = _frame_allocator.allocate(_scene.num_instances() * sizeof(glm::mat4), 64);
+    if (!matrix_uniforms_allocation || !instance_transforms_allocation) {
+        throw std::runtime_error("Out of frame allocator space for uniforms");
+    }
+    memcpy(matrix_uniforms_allocation->data, &matrix_uniforms, sizeof(MatrixUniforms));
+
+    const std::chrono::duration<double> time = std::chrono::steady_clock::now() - _start_time;
+    const auto transforms = static_cast<glm::mat4 *>(instance_transforms_allocation->data);
+    auto num_instances = _scene.num_instances();
+    if (_culling_mode == CullingMode::Cpu) {
+        num_instances = _scene.write_visible_transforms(time.count(), Frustum::from_view_projection(matrix_uniforms.projection * matrix_uniforms.view), transforms, _job_system);
+    } else {
+        _scene.write_transforms(time.count(), transforms, _job_system);
+    }
+    _frame_allocator.flush();
+
+    // Draws culled by the previous frame, in the region before the one this frame culls into. The
+    // very first frame has nothing culled yet and draws nothing.
+    const bool has_culled_draws = _num_culled_frames > 0;
+    const auto draws_offset = ((_num_culled_frames + num_draw_regions() - 1) % num_draw_regions()) * _draw_buffer_stride;
+    // The last one is only bound with GPU culling, for the visible instance ids
+    const std::array dynamic_offsets {
+        static_cast<uint32_t>(matrix_uniforms_allocation->offset),
+        static_cast<uint32_t>(instance_transforms_allocation->offset),
+        static_cast<uint32_t>(draws_offset)
+    };
+    const uint32_t num_dynamic_offsets = _culling_mode == CullingMode::Gpu ? 3 : 2;
+    if (_culling_mode == CullingMode::Gpu) {
+        record_culling(matrix_uniforms.projection * matrix_uniforms.view, dynamic_offsets[1],
+            (_num_culled_frames % num_draw_regions()) * _draw_buffer_stride);
+        ++_num_culled_frames;
+    }
+
+    // Secondary command buffers inherit none of this state, so each one binds everything itself
+    const auto record_draws = [&](VkCommandBuffer draw_cb, uint32_t, uint32_t count) {
+        vkCmdBindDescriptorSets(draw_cb, VK_PIPELINE_BIND_POINT_GRAPHICS, d.pipeline_layout, 0, 1, &d.descriptor_set, num_dynamic_offsets, dynamic_offsets.data());
+        vkCmdBindPipeline(draw_cb, VK_PIPELINE_BIND_POINT_GRAPHICS, d.pipeline);
+        vkCmdBindIndexBuffer(draw_cb, d.index_buffer, null_offset, VK_INDEX_TYPE_UINT16);
+        vkCmdBindVertexBuffers(draw_cb, 0, 1, &d.vertex_buffer, &null_offset);
+        vkCmdSetScissor(draw_cb, 0, 1, &scissor);
+        vkCmdSetViewport(draw_cb, 0, 1, &viewport);
+        for (uint32_t i = 0; i < count; ++i) {
+            if (_culling_mode == CullingMode::Gpu) {
+                if (!has_culled_draws) {
+                    break;
+                }
+                vkCmdDrawIndexedIndirectCount(draw_cb, d.draw_buffer, draws_offset + offsetof(CulledDraw, command),
+                    d.draw_buffer, draws_offset + offsetof(CulledDraw, draw_count), 1, sizeof(VkDrawIndexedIndirectCommand));
+            } else {
+                vkCmdDrawIndexed(draw_cb, INDICES.size(), num_instances, 0, 0, 0);
+            }
+        }
+    };
+
+    const auto recording_begin = std::chrono::steady_clock::now();
+    const std::vector<VkCommandBuffer> *secondaries = nullptr;
+    if (use_secondaries) {
+        const auto color_format = _swapchain.format();
+        const VkCommandBufferInheritanceRenderingInfo inheritance_rendering_info {
+            .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_RENDERING_INFO,
+            .colorAttachmentCount = 1,
+            .pColorAttachmentFormats = &color_format,
+            .depthAttachmentFormat = _swapchain.depth_format(),
+            .rasterizationSamples = VK_SAMPLE_COUNT_1_BIT
+        };
+        secondaries = &_recording_workers.record(_job_system, _frame_index, inheritance_rendering_info, _draw_count, record_draws);
+    }
 
     check_success(vkResetCommandPool(d.device, frame().command_pool, 0));
     
     const auto cb = frame().command_buffer;
     check_success(vkBeginCommandBuffer(cb, &command_buffer_begin_info));
-    vkCmdBeginRenderPass(cb, &render_pass_begin_info, VK_SUBPASS_CONTENTS_INLINE);
-    vkCmdBindDescriptorSets(cb, VK_PIPELINE_BIND_POINT_GRAPHICS, d.pipeline_layout, 0, 1, &d.descriptor_set, 1, &matrix_uniforms_offset);
-    vkCmdBindPipeline(cb, VK_PIPELINE_BIND_POINT_GRAPHICS, d.pipeline);
-    vkCmdBindIndexBuffer(cb, d.index_buffer, null_offset, VK_INDEX_TYPE_UINT16);
-    vkCmdBindVertexBuffers(cb, 0, 1, &d.vertex_buffer, &null_offset);
-    vkCmdSetScissor(cb, 0, 1, &scissor);
-    vkCmdSetViewport(cb, 0, 1, &viewport);
-    vkCmdDrawIndexed(cb, 3, 1, 0, 0, 0);
-    vkCmdEndRenderPass(cb);
+    _graphics_timestamps.write_begin(cb, _frame_index);
+    vkCmdPipelineBarrier2(cb, &begin_dependency_info);
+    vkCmdBeginRendering(cb, &rendering_info);
+    if (secondaries) {
+        vkCmdExecuteCommands(cb, static_cast<uint32_t>(secondaries->size()), secondaries->data());
+    } else {
+        record_draws(cb, 0, _draw_count);
+    }
+    vkCmdEndRendering(cb);
+    vkCmdPipelineBarrier2(cb, &end_dependency_info);
+    _graphics_timestamps.write_end(cb, _frame_index);
     check_success(vkEndCommandBuffer(cb));
+
+    const std::chrono::duration<double, std::milli> recording_time = std::chrono::steady_clock::now() - recording_begin;
+    ++_recording_statistics.num_frames;
+    _recording_statistics.average_ms += recording_time.count();
+    _recording_statistics.max_ms = std::max(_recording_statistics.max_ms, recording_time.count());
 }
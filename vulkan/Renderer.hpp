@@ -1,21 +1,66 @@
 #pragma once
 
+#include "PresentWaiter.hpp"
 #include "RendererBase.hpp"
 
+#include "CullingMode.hpp"
+#include "JobSystem.hpp"
+#include "scene/Scene.hpp"
+
+#include <chrono>
+#include <span>
+
 class Window;
 
+struct RecordingStatistics {
+    uint32_t num_frames;
+    uint32_t draw_count;
+    // Secondary command buffers recorded as jobs, 0 if draws are recorded straight into the primary command buffer
+    size_t num_slices;
+    size_t num_threads;
+    // CPU time spent recording a frame's command buffers
+    double average_ms, max_ms;
+};
+
 class Renderer : private RendererBase {
 public:
     Renderer(Window& window);
     ~Renderer();
 
     FrameData& frame() noexcept;
+    size_t frames_in_flight() const noexcept;
+    FrameAllocatorStatistics frame_allocator_statistics() const noexcept;
+    // Averages are only populated for frames that submitted compute work on a queue with timestamp support, and
+    // with VK_EXT_calibrated_timestamps to compare the two queues' timestamps
+    ComputeOverlapStatistics compute_overlap_statistics() const noexcept;
+    // Number of frames the GPU has finished executing
+    uint64_t completed_frames() const;
+    // Number of frames submitted so far, frame n signals the frame timeline with value n
+    uint64_t submitted_frames() const noexcept;
+    // Blocks until the given frame has finished executing, returns false on timeout
+    bool wait_for_frame(uint64_t frame_number, uint64_t timeout_ns = UINT64_MAX) const;
+    RecordingStatistics recording_statistics() const noexcept;
+    TransformStatistics transform_statistics() const noexcept;
+    // Only populated with CPU culling
+    CullingStatistics culling_statistics() const noexcept;
+    // Only populated with VK_KHR_present_wait
+    LatencyStatistics present_latency_statistics() const;
     void render();
 
 private:
-    void record_command_buffer();
+    void collect_compute_overlap();
+    // Culling runs on the compute queue, writing indirect draws for the next frame's graphics submission
+    void init_gpu_culling(std::span<const uint32_t> queue_families);
+    size_t num_draw_regions() const noexcept;
+    void record_culling(const glm::mat4& view_projection, uint32_t instance_transforms_offset, VkDeviceSize draws_offset);
+    // Acquire barriers complete ownership transfers of buffers uploaded on the transfer queue
+    void record_command_buffer(const std::vector<VkBufferMemoryBarrier2>& acquire_barriers);
+    void wait_for_presents();
 private:
-    const Window& _window;
+    Window& _window;
+    JobSystem _job_system;
+    Scene _scene;
+    std::chrono::steady_clock::time_point _start_time;
 
     VkPhysicalDevice _physical_device;
     uint32_t _queue_family_index;
@@ -23,4 +68,23 @@ private:
     VkQueue _queue;
     
     size_t _frame_index;
+    uint64_t _frame_number;
+
+    // Only started with VK_KHR_present_wait
+    PresentWaiter _present_waiter;
+    TimestampCalibration _timestamp_calibration;
+    // Sums over every measured frame
+    ComputeOverlapStatistics _compute_overlap;
+
+    // Number of times the scene is drawn per frame, to load the CPU with command recording
+    uint32_t _draw_count;
+    // Sums over every recorded frame
+    RecordingStatistics _recording_statistics;
+    // With GPU culling instances are culled by a compute shader and drawn with vkCmdDrawIndexedIndirectCount
+    CullingMode _culling_mode;
+    VkDeviceSize _draw_buffer_stride;
+    // Frames culled so far, each culls into the next region of the draw buffer
+    uint64_t _num_culled_frames;
+    // Latency limiter, 0 leaves it to the swapchain image count
+    uint32_t _max_queued_frames;
 };
@@ -10,19 +10,27 @@ RendererBase::~RendererBase() {
     if (d.device) {
         for (const auto& frame_data : d.frame_data) {
             vkDestroySemaphore(d.device, frame_data.semaphore, nullptr);   
-            vkDestroyFence(d.device, frame_data.fence, nullptr);
             vkDestroyCommandPool(d.device, frame_data.command_pool, nullptr);        
         }
+        vkDestroySemaphore(d.device, d.frame_timeline, nullptr);
 
-        vmaDestroyBuffer(d.allocator, d.uniform_buffer, d.uniform_allocation);
+        _upload_manager.destroy();
+        _compute_queue.destroy();
+        _recording_workers.destroy();
+        _graphics_timestamps.destroy();
+        _frame_allocator.destroy();
         vmaDestroyBuffer(d.allocator, d.vertex_buffer, d.vertex_allocation);
         vmaDestroyBuffer(d.allocator, d.index_buffer, d.index_allocation);
+        vmaDestroyBuffer(d.allocator, d.draw_buffer, d.draw_allocation);
 
+        vkDestroyPipeline(d.device, d.cull_pipeline, nullptr);
         vkDestroyPipeline(d.device, d.pipeline, nullptr);
+        _pipeline_cache.destroy();
         vkDestroyDescriptorPool(d.device, d.descriptor_pool, nullptr);
 
-        vkDestroyRenderPass(d.device, d.render_pass, nullptr);
+        vkDestroyPipelineLayout(d.device, d.cull_pipeline_layout, nullptr);
         vkDestroyPipelineLayout(d.device, d.pipeline_layout, nullptr);
+        vkDestroyDescriptorSetLayout(d.device, d.cull_descriptor_set_layout, nullptr);
         vkDestroyDescriptorSetLayout(d.device, d.descriptor_set_layout, nullptr);
 
         vmaDestroyAllocator(d.allocator);
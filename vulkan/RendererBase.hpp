@@ -1,17 +1,25 @@
 #pragma once
 
+#include "ComputeQueue.hpp"
+#include "FrameAllocator.hpp"
+#include "PipelineCache.hpp"
+#include "RecordingWorkers.hpp"
 #include "Swapchain.hpp"
+#include "UploadManager.hpp"
 
-#include <array>
+#include <vector>
 
-inline constexpr size_t NUM_FRAMES_IN_FLIGHT = 2;
+inline constexpr size_t DEFAULT_FRAMES_IN_FLIGHT = 2;
+inline constexpr size_t MAX_FRAMES_IN_FLIGHT = 4;
 
 struct FrameData {
     VkCommandPool command_pool;
     VkCommandBuffer command_buffer;
 
-    VkFence fence;
+    // Acquire semaphore, the frame timeline tracks when the submission using it completes
     VkSemaphore semaphore;
+    // Frame timeline value signalled by the last submission from this frame, 0 if none
+    uint64_t timeline_value;
 };
 
 class RendererBase {
@@ -33,17 +41,33 @@ protected:
 
         VkDescriptorSetLayout descriptor_set_layout;
         VkPipelineLayout pipeline_layout;
-        VkRenderPass render_pass;
 
         VkDescriptorPool descriptor_pool;
         VkDescriptorSet descriptor_set;
         VkPipeline pipeline;
 
-        VkBuffer index_buffer, vertex_buffer, uniform_buffer;
-        VmaAllocation index_allocation, vertex_allocation, uniform_allocation;
+        VkBuffer index_buffer, vertex_buffer;
+        VmaAllocation index_allocation, vertex_allocation;
 
-        std::array<FrameData, NUM_FRAMES_IN_FLIGHT> frame_data;
+        // GPU culling, only created when it is enabled
+        VkDescriptorSetLayout cull_descriptor_set_layout;
+        VkPipelineLayout cull_pipeline_layout;
+        VkDescriptorSet cull_descriptor_set;
+        VkPipeline cull_pipeline;
+        // One region of indirect draw commands per frame in flight plus one, each preceded by its draw count
+        VkBuffer draw_buffer;
+        VmaAllocation draw_allocation;
+
+        // Timeline semaphore incremented by every submitted frame
+        VkSemaphore frame_timeline;
+        std::vector<FrameData> frame_data;
     } d;
 
+    ComputeQueue _compute_queue;
+    FrameAllocator _frame_allocator;
+    TimestampQueries _graphics_timestamps;
+    PipelineCache _pipeline_cache;
+    RecordingWorkers _recording_workers;
     Swapchain _swapchain;
+    UploadManager _upload_manager;
 };
@@ -3,11 +3,14 @@
 #include "Common.hpp"
 
 #include <volk.h>
+#include <vulkan/vk_enum_string_helper.h>
 
 #include <algorithm>
 #include <array>
+#include <cstdio>
 #include <memory>
 #include <stdexcept>
+#include <utility>
 
 static constexpr uint32_t DEFAULT_IMAGE_COUNT = 3;
 static constexpr std::array DESIRED_COLOR_FORMATS {
@@ -20,6 +23,22 @@ static constexpr std::array DESIRED_DEPTH_FORMATS {
     VK_FORMAT_X8_D24_UNORM_PACK32
 };
 
+// Most preferred first, FIFO is last as it is the only mode guaranteed to be supported
+static constexpr std::array POWER_SAVING_PRESENT_MODES {
+    VK_PRESENT_MODE_FIFO_KHR
+};
+static constexpr std::array LOW_LATENCY_PRESENT_MODES {
+    VK_PRESENT_MODE_MAILBOX_KHR,
+    VK_PRESENT_MODE_FIFO_RELAXED_KHR,
+    VK_PRESENT_MODE_FIFO_KHR
+};
+static constexpr std::array TEAR_ALLOWED_PRESENT_MODES {
+    VK_PRESENT_MODE_IMMEDIATE_KHR,
+    VK_PRESENT_MODE_FIFO_RELAXED_KHR,
+    VK_PRESENT_MODE_MAILBOX_KHR,
+    VK_PRESENT_MODE_FIFO_KHR
+};
+
 static VkFormat select_depth_format(VkPhysicalDevice physical_device) {
     for (const auto format : DESIRED_DEPTH_FORMATS) {
         VkFormatProperties format_props;
@@ -32,6 +51,41 @@ static VkFormat select_depth_format(VkPhysicalDevice physical_device) {
     throw std::runtime_error("No supported depth format");
 }
 
+static bool has_lazily_allocated_memory(VkPhysicalDevice physical_device) {
+    VkPhysicalDeviceMemoryProperties memory_props;
+    vkGetPhysicalDeviceMemoryProperties(physical_device, &memory_props);
+    for (uint32_t i = 0; i < memory_props.memoryTypeCount; ++i) {
+        if (memory_props.memoryTypes[i].propertyFlags & VK_MEMORY_PROPERTY_LAZILY_ALLOCATED_BIT) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Attachments that are cleared on load and never stored only live in tile memory on tiled GPUs,
+// so lazily allocated memory may never be backed by physical pages at all. Returns true if the
+// image ended up in lazily allocated memory.
+static bool create_transient_attachment(VmaAllocator allocator, const VkImageCreateInfo& image_create_info, bool try_lazy, VkImage *image, VmaAllocation *allocation) {
+    if (try_lazy) {
+        const VmaAllocationCreateInfo lazy_allocate_info {
+            .flags = VMA_ALLOCATION_CREATE_DEDICATED_MEMORY_BIT,
+            .usage = VMA_MEMORY_USAGE_GPU_LAZILY_ALLOCATED,
+            .priority = RENDER_TARGET_PRIORITY
+        };
+        // Fails with FEATURE_NOT_PRESENT if no lazily allocated type suits this image
+        if (VK_SUCCESS == vmaCreateImage(allocator, &image_create_info, &lazy_allocate_info, image, allocation, nullptr)) {
+            return true;
+        }
+    }
+
+    const VmaAllocationCreateInfo allocate_info {
+        .usage = VMA_MEMORY_USAGE_AUTO_PREFER_DEVICE,
+        .priority = RENDER_TARGET_PRIORITY
+    };
+    check_success(vmaCreateImage(allocator, &image_create_info, &allocate_info, image, allocation, nullptr));
+    return false;
+}
+
 static VkSurfaceFormatKHR select_surface_format(VkPhysicalDevice physical_device, VkSurfaceKHR surface) {
     uint32_t num_formats;
     check_success(vkGetPhysicalDeviceSurfaceFormatsKHR(physical_device, surface, &num_formats, nullptr));
@@ -52,8 +106,59 @@ static VkSurfaceFormatKHR select_surface_format(VkPhysicalDevice physical_device
     throw std::runtime_error("No supported surface format");
 }
 
+static VkPresentModeKHR select_present_mode(VkPhysicalDevice physical_device, VkSurfaceKHR surface, PresentPolicy policy) {
+    uint32_t num_present_modes;
+    check_success(vkGetPhysicalDeviceSurfacePresentModesKHR(physical_device, surface, &num_present_modes, nullptr));
+    const auto present_modes = std::make_unique_for_overwrite<VkPresentModeKHR[]>(num_present_modes);
+    check_success(vkGetPhysicalDeviceSurfacePresentModesKHR(physical_device, surface, &num_present_modes, present_modes.get()));
+
+    const auto is_supported = [&](VkPresentModeKHR present_mode) {
+        return std::find(present_modes.get(), present_modes.get() + num_present_modes, present_mode) != present_modes.get() + num_present_modes;
+    };
+    const auto select_first_supported = [&](const auto& desired_present_modes) {
+        for (const auto present_mode : desired_present_modes) {
+            if (is_supported(present_mode)) {
+                return present_mode;
+            }
+        }
+        return VK_PRESENT_MODE_FIFO_KHR;
+    };
+
+    switch (policy) {
+    case PresentPolicy::LowLatency:
+        return select_first_supported(LOW_LATENCY_PRESENT_MODES);
+    case PresentPolicy::TearAllowed:
+        return select_first_supported(TEAR_ALLOWED_PRESENT_MODES);
+    case PresentPolicy::PowerSaving:
+    default:
+        return select_first_supported(POWER_SAVING_PRESENT_MODES);
+    }
+}
+
+static uint32_t select_image_count(const VkSurfaceCapabilitiesKHR& surface_caps, VkPresentModeKHR present_mode) {
+    uint32_t image_count;
+    switch (present_mode) {
+    case VK_PRESENT_MODE_IMMEDIATE_KHR:
+        // Images are never held waiting for vblank, so one spare is enough to avoid blocking on acquire
+        image_count = surface_caps.minImageCount + 1;
+        break;
+    case VK_PRESENT_MODE_MAILBOX_KHR:
+    case VK_PRESENT_MODE_FIFO_KHR:
+    case VK_PRESENT_MODE_FIFO_RELAXED_KHR:
+    default:
+        // One image on screen, one queued and one being rendered
+        image_count = std::max(surface_caps.minImageCount + 1, DEFAULT_IMAGE_COUNT);
+        break;
+    }
+
+    if (surface_caps.maxImageCount) {
+        image_count = std::min(image_count, surface_caps.maxImageCount);
+    }
+    return image_count;
+}
+
 bool Swapchain::acquire(VkSemaphore semaphore) {
-    const auto result = vkAcquireNextImageKHR(_device, d.swapchain, UINT64_MAX, semaphore, nullptr, &_image_index);
+    const auto result = vkAcquireNextImageKHR(_device, d.current.swapchain, UINT64_MAX, semaphore, nullptr, &_image_index);
     switch (result) {
     case VK_SUCCESS:
         return true;
@@ -68,78 +173,152 @@ bool Swapchain::acquire(VkSemaphore semaphore) {
     }
 }
 
-void Swapchain::destroy(bool destroy_current_swapchain) {
-    vkDestroyImageView(_device, d.depth_view, nullptr);
-    vmaDestroyImage(_allocator, d.depth_image, d.depth_allocation);
-
-    for (auto& image_data : d.image_data) {
-        vkDestroySemaphore(_device, image_data.semaphore, nullptr);
-        vkDestroyFramebuffer(_device, image_data.framebuffer, nullptr);
-        vkDestroyImageView(_device, image_data.image_view, nullptr);
+void Swapchain::destroy() {
+    if (d.current.swapchain) {
+        d.retired.push_back(std::exchange(d.current, {}));
     }
-    d.image_data.clear();
+    destroy_retired(true);
+}
+
+void Swapchain::destroy_retired(bool wait) noexcept {
+    const auto presents_finished = [this, wait](const SwapchainData& retired) {
+        for (const auto& image_data : retired.image_data) {
+            if (image_data.present_pending) {
+                const auto result = wait
+                    ? vkWaitForFences(_device, 1, &image_data.present_fence, true, UINT64_MAX)
+                    : vkGetFenceStatus(_device, image_data.present_fence);
+                if (result != VK_SUCCESS) {
+                    return false;
+                }
+            }
+        }
+        return true;
+    };
 
-    vkDestroySwapchainKHR(_device, d.old_swapchain, nullptr);
-    if (destroy_current_swapchain) {
-        vkDestroySwapchainKHR(_device, d.swapchain, nullptr);
+    for (auto p = d.retired.begin(); p != d.retired.end();) {
+        if (presents_finished(*p)) {
+            SwapchainBase::destroy(*p);
+            p = d.retired.erase(p);
+        } else {
+            ++p;
+        }
     }
-    d.old_swapchain = d.swapchain;
 }
 
 VkFormat Swapchain::depth_format() const noexcept {
     return _depth_format;
 }
 
+VkImage Swapchain::depth_image() noexcept {
+    return d.current.depth_image;
+}
+
+VkImageView Swapchain::depth_view() noexcept {
+    return d.current.depth_view;
+}
+
 VkFormat Swapchain::format() const noexcept {
     return _format.format;
 }
 
 ImageData& Swapchain::image_data() {
-    return d.image_data[_image_index];
+    return d.current.image_data[_image_index];
 }
 
 const ImageData& Swapchain::image_data() const {
-    return d.image_data[_image_index];
+    return d.current.image_data[_image_index];
 }
 
-void Swapchain::init(VkDevice device, VmaAllocator allocator, VkSurfaceKHR surface, VkPhysicalDevice physical_device) {
+bool Swapchain::has_present_wait() const noexcept {
+    return _has_present_wait;
+}
+
+void Swapchain::init(VkDevice device, VmaAllocator allocator, VkSurfaceKHR surface, VkPhysicalDevice physical_device, bool has_swapchain_maintenance_1, bool has_present_wait) {
     _device = device;
     _allocator = allocator;
     _surface = surface;
     _physical_device = physical_device;
+    _has_swapchain_maintenance_1 = has_swapchain_maintenance_1;
+    _has_present_wait = has_present_wait;
+    _present_id = 0;
 
     _format = select_surface_format(_physical_device, _surface);
     _depth_format = select_depth_format(_physical_device);
+    _has_lazily_allocated_memory = has_lazily_allocated_memory(_physical_device);
 
+    _present_policy = PresentPolicy::PowerSaving;
+    _present_mode = VK_PRESENT_MODE_FIFO_KHR;
     _rebuild_required = true;
 }
 
-void Swapchain::present(VkQueue queue) {
+bool Swapchain::present(VkQueue queue) {
+    auto& image = image_data();
+
+    void *optional_pnext_chain = nullptr;
+    VkSwapchainPresentFenceInfoEXT present_fence_info {
+        .sType = VK_STRUCTURE_TYPE_SWAPCHAIN_PRESENT_FENCE_INFO_EXT,
+        .swapchainCount = 1,
+        .pFences = &image.present_fence
+    };
+    if (_has_swapchain_maintenance_1) {
+        // The image has been reacquired, so its previous present has long finished
+        if (image.present_pending) {
+            check_success(vkWaitForFences(_device, 1, &image.present_fence, true, UINT64_MAX));
+        }
+        check_success(vkResetFences(_device, 1, &image.present_fence));
+        image.present_pending = true;
+
+        present_fence_info.pNext = std::exchange(optional_pnext_chain, &present_fence_info);
+
+        destroy_retired(false);
+    }
+
+    // Ids only need to increase within a swapchain, so one counter serves every swapchain
+    const uint64_t present_id = _present_id + 1;
+    VkPresentIdKHR present_id_info {
+        .sType = VK_STRUCTURE_TYPE_PRESENT_ID_KHR,
+        .swapchainCount = 1,
+        .pPresentIds = &present_id
+    };
+    if (_has_present_wait) {
+        _present_id = present_id;
+        present_id_info.pNext = std::exchange(optional_pnext_chain, &present_id_info);
+    }
+
     const VkPresentInfoKHR present_info {
         .sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR,
+        .pNext = optional_pnext_chain,
         .waitSemaphoreCount = 1,
-        .pWaitSemaphores = &image_data().semaphore,
+        .pWaitSemaphores = &image.semaphore,
         .swapchainCount = 1,
-        .pSwapchains = &d.swapchain,
+        .pSwapchains = &d.current.swapchain,
         .pImageIndices = &_image_index
     };
     const auto result = vkQueuePresentKHR(queue, &present_info);
     switch (result) {
     case VK_SUCCESS:
-        break;
+        return true;
     case VK_SUBOPTIMAL_KHR:
+        _rebuild_required = true;
+        return true;
     case VK_ERROR_OUT_OF_DATE_KHR:
         _rebuild_required = true;
-        break;
+        return false;
     default:
         throw BadVkResult(result);
     }
 }
 
-void Swapchain::rebuild(const std::pair<uint32_t, uint32_t>& window_size, VkRenderPass render_pass) {
+void Swapchain::rebuild(const std::pair<uint32_t, uint32_t>& window_size) {
+    const auto previous_present_mode = std::exchange(_present_mode, select_present_mode(_physical_device, _surface, _present_policy));
+    if (previous_present_mode != _present_mode || !d.current.swapchain) {
+        std::printf("Present mode: %s (%s)\n", string_VkPresentModeKHR(_present_mode), to_string(_present_policy));
+    }
+
+    // Capabilities such as minImageCount depend on the present mode
     const VkSurfacePresentModeEXT present_mode {
         .sType = VK_STRUCTURE_TYPE_SURFACE_PRESENT_MODE_EXT,
-        .presentMode = VK_PRESENT_MODE_FIFO_KHR // Always supported
+        .presentMode = _present_mode
     };
     const VkPhysicalDeviceSurfaceInfo2KHR surface_info {
         .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_SURFACE_INFO_2_KHR,
@@ -151,10 +330,7 @@ void Swapchain::rebuild(const std::pair<uint32_t, uint32_t>& window_size, VkRend
     };
     check_success(vkGetPhysicalDeviceSurfaceCapabilities2KHR(_physical_device, &surface_info, &surface_caps2));
 
-    auto image_count = std::max(surface_caps2.surfaceCapabilities.minImageCount + 1, DEFAULT_IMAGE_COUNT);
-    if (surface_caps2.surfaceCapabilities.maxImageCount) {
-        image_count = std::max(image_count, surface_caps2.surfaceCapabilities.maxImageCount);
-    }
+    const auto image_count = select_image_count(surface_caps2.surfaceCapabilities, _present_mode);
     
     VkCompositeAlphaFlagBitsKHR compositeAlpha;
     if (surface_caps2.surfaceCapabilities.supportedCompositeAlpha & VK_COMPOSITE_ALPHA_OPAQUE_BIT_KHR) {
@@ -170,7 +346,11 @@ void Swapchain::rebuild(const std::pair<uint32_t, uint32_t>& window_size, VkRend
         std::clamp(window_size.second, surface_caps2.surfaceCapabilities.minImageExtent.height, surface_caps2.surfaceCapabilities.maxImageExtent.height),
     };
 
-    destroy();
+    // The old swapchain stays alive until it is no longer needed as oldSwapchain,
+    // and with EXT_swapchain_maintenance1 until its last present fence signals
+    if (d.current.swapchain) {
+        d.retired.push_back(std::exchange(d.current, {}));
+    }
     const VkSwapchainCreateInfoKHR swapchain_create_info {
         .sType = VK_STRUCTURE_TYPE_SWAPCHAIN_CREATE_INFO_KHR,
         .surface = _surface,
@@ -184,9 +364,10 @@ void Swapchain::rebuild(const std::pair<uint32_t, uint32_t>& window_size, VkRend
         .compositeAlpha = compositeAlpha,
         .presentMode = present_mode.presentMode,
         .clipped = true,
-        .oldSwapchain = d.old_swapchain
+        .oldSwapchain = d.retired.empty() ? nullptr : d.retired.back().swapchain
     };
-    check_success(vkCreateSwapchainKHR(_device, &swapchain_create_info, nullptr, &d.swapchain));
+    check_success(vkCreateSwapchainKHR(_device, &swapchain_create_info, nullptr, &d.current.swapchain));
+    destroy_retired(!_has_swapchain_maintenance_1);
 
     const VkImageCreateInfo depth_image_create_info {
         .sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO,
@@ -197,17 +378,17 @@ void Swapchain::rebuild(const std::pair<uint32_t, uint32_t>& window_size, VkRend
         .arrayLayers = 1,
         .samples = VK_SAMPLE_COUNT_1_BIT,
         .tiling = VK_IMAGE_TILING_OPTIMAL,
-        .usage = VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT,
+        .usage = VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSIENT_ATTACHMENT_BIT,
     };
-    const VmaAllocationCreateInfo depth_image_allocate_info {
-        .usage = VMA_MEMORY_USAGE_AUTO_PREFER_DEVICE,
-        .priority = RENDER_TARGET_PRIORITY
-    };
-    vmaCreateImage(_allocator, &depth_image_create_info, &depth_image_allocate_info, &d.depth_image, &d.depth_allocation, nullptr);
+    const auto depth_is_lazy = create_transient_attachment(
+        _allocator, depth_image_create_info, _has_lazily_allocated_memory,
+        &d.current.depth_image, &d.current.depth_allocation
+    );
+    report_attachment_memory("Depth", d.current.depth_allocation, depth_is_lazy);
 
     const VkImageViewCreateInfo depth_view_create_info {
         .sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO,
-        .image = d.depth_image,
+        .image = d.current.depth_image,
         .viewType = VK_IMAGE_VIEW_TYPE_2D,
         .format = _depth_format,
         .subresourceRange = { 
@@ -216,16 +397,16 @@ void Swapchain::rebuild(const std::pair<uint32_t, uint32_t>& window_size, VkRend
             0, 1
         }
     };
-    check_success(vkCreateImageView(_device, &depth_view_create_info, nullptr, &d.depth_view));
+    check_success(vkCreateImageView(_device, &depth_view_create_info, nullptr, &d.current.depth_view));
 
     uint32_t num_images;
-    check_success(vkGetSwapchainImagesKHR(_device, d.swapchain, &num_images, nullptr));
+    check_success(vkGetSwapchainImagesKHR(_device, d.current.swapchain, &num_images, nullptr));
     const auto images = std::make_unique_for_overwrite<VkImage[]>(num_images);
-    check_success(vkGetSwapchainImagesKHR(_device, d.swapchain, &num_images, images.get()));
+    check_success(vkGetSwapchainImagesKHR(_device, d.current.swapchain, &num_images, images.get()));
 
-    d.image_data.resize(num_images);
+    d.current.image_data.resize(num_images);
     for (uint32_t i = 0; i < num_images; ++i) {
-        auto& image_data = d.image_data[i];
+        auto& image_data = d.current.image_data[i];
         image_data.image = images[i];
 
         const VkImageViewCreateInfo image_view_create_info {
@@ -241,31 +422,65 @@ void Swapchain::rebuild(const std::pair<uint32_t, uint32_t>& window_size, VkRend
         };
         check_success(vkCreateImageView(_device, &image_view_create_info, nullptr, &image_data.image_view));
 
-        const std::array attachments { image_data.image_view, d.depth_view };
-        const VkFramebufferCreateInfo framebuffer_create_info {
-            .sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO,
-            .renderPass = render_pass,
-            .attachmentCount = attachments.size(),
-            .pAttachments = attachments.data(),
-            .width = _size.width,
-            .height = _size.height,
-            .layers = 1
-        };
-        check_success(vkCreateFramebuffer(_device, &framebuffer_create_info, nullptr, &image_data.framebuffer));
-
         const VkSemaphoreCreateInfo semaphore_create_info {
             .sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO
         };
         check_success(vkCreateSemaphore(_device, &semaphore_create_info, nullptr, &image_data.semaphore));
+
+        if (_has_swapchain_maintenance_1) {
+            const VkFenceCreateInfo fence_create_info {
+                .sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO
+            };
+            check_success(vkCreateFence(_device, &fence_create_info, nullptr, &image_data.present_fence));
+        }
     }
 
     _rebuild_required = false;
 }
 
+void Swapchain::report_attachment_memory(const char *name, VmaAllocation allocation, bool is_lazy) const noexcept {
+    VmaAllocationInfo allocation_info;
+    vmaGetAllocationInfo(_allocator, allocation, &allocation_info);
+
+    if (is_lazy) {
+        VkDeviceSize committed;
+        vkGetDeviceMemoryCommitment(_device, allocation_info.deviceMemory, &committed);
+        std::printf("%s attachment %ux%u: %llu KiB lazily allocated, %llu KiB committed\n",
+            name, _size.width, _size.height,
+            static_cast<unsigned long long>(allocation_info.size / 1024), static_cast<unsigned long long>(committed / 1024));
+    } else {
+        std::printf("%s attachment %ux%u: %llu KiB device memory\n",
+            name, _size.width, _size.height, static_cast<unsigned long long>(allocation_info.size / 1024));
+    }
+}
+
+uint64_t Swapchain::last_present_id() const noexcept {
+    return _present_id;
+}
+
+PresentPolicy Swapchain::present_policy() const noexcept {
+    return _present_policy;
+}
+
+VkPresentModeKHR Swapchain::present_mode() const noexcept {
+    return _present_mode;
+}
+
+void Swapchain::set_present_policy(PresentPolicy policy) noexcept {
+    if (policy != _present_policy) {
+        _present_policy = policy;
+        _rebuild_required = true;
+    }
+}
+
 bool Swapchain::rebuild_required() const noexcept {
     return _rebuild_required;
 }
 
+bool Swapchain::rebuild_requires_idle() const noexcept {
+    return !_has_swapchain_maintenance_1;
+}
+
 VkExtent2D Swapchain::size() const noexcept {
     return _size;
 }
@@ -2,13 +2,18 @@
 
 #include "SwapchainBase.hpp"
 
+#include "PresentPolicy.hpp"
+
 class Swapchain : private SwapchainBase {
 public:
     bool acquire(VkSemaphore semaphore);
 
-    void destroy(bool destroy_current_swapchain = false);
+    // Waits for outstanding presents and destroys every swapchain, current and retired
+    void destroy();
 
     VkFormat depth_format() const noexcept;
+    VkImage depth_image() noexcept;
+    VkImageView depth_view() noexcept;
     VkFormat format() const noexcept;
 
     VkSwapchainKHR handle() noexcept;
@@ -16,15 +21,32 @@ public:
     ImageData& image_data();
     const ImageData& image_data() const;
 
-    void init(VkDevice device, VmaAllocator allocator, VkSurfaceKHR surface, VkPhysicalDevice physical_device);
+    void init(VkDevice device, VmaAllocator allocator, VkSurfaceKHR surface, VkPhysicalDevice physical_device, bool has_swapchain_maintenance_1, bool has_present_wait);
+
+    // Present ids are only assigned when KHR_present_id and KHR_present_wait are enabled
+    bool has_present_wait() const noexcept;
+    // Id given to the most recent present(), 0 if none
+    uint64_t last_present_id() const noexcept;
+
+    // Returns false if the image could not be queued for presentation
+    bool present(VkQueue queue);
 
-    void present(VkQueue queue);
+    PresentPolicy present_policy() const noexcept;
+    VkPresentModeKHR present_mode() const noexcept;
+    // Takes effect at the next rebuild, which is forced if the policy changed
+    void set_present_policy(PresentPolicy policy) noexcept;
 
     bool rebuild_required() const noexcept;
-    void rebuild(const std::pair<uint32_t, uint32_t>& size, VkRenderPass render_pass);
+    // Without present fences the old swapchain can only be destroyed once the queue is idle
+    bool rebuild_requires_idle() const noexcept;
+    void rebuild(const std::pair<uint32_t, uint32_t>& size);
 
     VkExtent2D size() const noexcept;
 
+private:
+    void destroy_retired(bool wait) noexcept;
+    void report_attachment_memory(const char *name, VmaAllocation allocation, bool is_lazy) const noexcept;
+
 private:
     VkSurfaceKHR _surface;
     VkPhysicalDevice _physical_device;
@@ -32,7 +54,14 @@ private:
     VkSurfaceFormatKHR _format;
     VkFormat _depth_format;
 
+    PresentPolicy _present_policy;
+    VkPresentModeKHR _present_mode;
+
     VkExtent2D _size;
     uint32_t _image_index;
     bool _rebuild_required;
+    bool _has_swapchain_maintenance_1;
+    bool _has_present_wait;
+    bool _has_lazily_allocated_memory;
+    uint64_t _present_id;
 };
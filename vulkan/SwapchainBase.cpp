@@ -6,3 +6,16 @@ SwapchainBase::SwapchainBase()
     :d{}
 {}
 
+void SwapchainBase::destroy(SwapchainData& data) noexcept {
+    vkDestroyImageView(_device, data.depth_view, nullptr);
+    vmaDestroyImage(_allocator, data.depth_image, data.depth_allocation);
+
+    for (auto& image_data : data.image_data) {
+        vkDestroyFence(_device, image_data.present_fence, nullptr);
+        vkDestroySemaphore(_device, image_data.semaphore, nullptr);
+        vkDestroyImageView(_device, image_data.image_view, nullptr);
+    }
+
+    vkDestroySwapchainKHR(_device, data.swapchain, nullptr);
+    data = {};
+}
@@ -6,8 +6,21 @@
 struct ImageData {
     VkImage image;
     VkImageView image_view;
-    VkFramebuffer framebuffer;
     VkSemaphore semaphore;
+
+    // Only used with EXT_swapchain_maintenance1, signalled once the last present of the image no longer needs its resources
+    VkFence present_fence;
+    bool present_pending;
+};
+
+// Everything that lives exactly as long as one VkSwapchainKHR
+struct SwapchainData {
+    VkSwapchainKHR swapchain;
+    VkImage depth_image;
+    VmaAllocation depth_allocation;
+    VkImageView depth_view;
+
+    std::vector<ImageData> image_data;
 };
 
 class SwapchainBase {
@@ -20,18 +33,15 @@ protected:
     SwapchainBase& operator=(const SwapchainBase&) = delete;
     SwapchainBase& operator=(SwapchainBase&&) noexcept = delete;
 
-    void destroy();
+    void destroy(SwapchainData& data) noexcept;
 
 protected:
     VkDevice _device;
     VmaAllocator _allocator;
 
     struct {
-        VkSwapchainKHR swapchain, old_swapchain;
-        VkImage depth_image;
-        VmaAllocation depth_allocation;
-        VkImageView depth_view;
-
-        std::vector<ImageData> image_data;
+        SwapchainData current;
+        // Replaced swapchains whose resources may still be in use by pending presents
+        std::vector<SwapchainData> retired;
     } d;
 };
@@ -0,0 +1,157 @@
+#include "TimestampQueries.hpp"
+
+#include "Common.hpp"
+
+#include <volk.h>
+
+#include <array>
+#include <memory>
+
+TimestampCalibration::TimestampCalibration()
+    :_device(nullptr)
+    ,_is_supported(false)
+    ,_period_ns(0.0)
+    ,_device_timestamp(0)
+    ,_host_ns(0)
+{}
+
+void TimestampCalibration::init(VkDevice device, VkPhysicalDevice physical_device, bool has_calibrated_timestamps) {
+    _device = device;
+    if (!has_calibrated_timestamps) {
+        return;
+    }
+
+    uint32_t num_time_domains;
+    check_success(vkGetPhysicalDeviceCalibrateableTimeDomainsEXT(physical_device, &num_time_domains, nullptr));
+    auto time_domains = std::make_unique_for_overwrite<VkTimeDomainEXT[]>(num_time_domains);
+    check_success(vkGetPhysicalDeviceCalibrateableTimeDomainsEXT(physical_device, &num_time_domains, time_domains.get()));
+
+    bool has_device = false;
+    bool has_monotonic = false;
+    for (uint32_t i = 0; i < num_time_domains; ++i) {
+        has_device |= VK_TIME_DOMAIN_DEVICE_EXT == time_domains[i];
+        has_monotonic |= VK_TIME_DOMAIN_CLOCK_MONOTONIC_EXT == time_domains[i];
+    }
+    if (!has_device || !has_monotonic) {
+        return;
+    }
+
+    VkPhysicalDeviceProperties physical_device_props;
+    vkGetPhysicalDeviceProperties(physical_device, &physical_device_props);
+    _period_ns = physical_device_props.limits.timestampPeriod;
+    _is_supported = true;
+    calibrate();
+}
+
+bool TimestampCalibration::is_supported() const noexcept {
+    return _is_supported;
+}
+
+void TimestampCalibration::calibrate() {
+    if (!_is_supported) {
+        return;
+    }
+
+    const std::array timestamp_infos {
+        VkCalibratedTimestampInfoEXT {
+            .sType = VK_STRUCTURE_TYPE_CALIBRATED_TIMESTAMP_INFO_EXT,
+            .timeDomain = VK_TIME_DOMAIN_DEVICE_EXT
+        },
+        VkCalibratedTimestampInfoEXT {
+            .sType = VK_STRUCTURE_TYPE_CALIBRATED_TIMESTAMP_INFO_EXT,
+            .timeDomain = VK_TIME_DOMAIN_CLOCK_MONOTONIC_EXT
+        }
+    };
+    std::array<uint64_t, 2> timestamps;
+    uint64_t max_deviation;
+    check_success(vkGetCalibratedTimestampsEXT(_device, timestamp_infos.size(), timestamp_infos.data(), timestamps.data(), &max_deviation));
+    _device_timestamp = timestamps[0];
+    _host_ns = timestamps[1];
+}
+
+double TimestampCalibration::to_host_ms(uint64_t timestamp, uint64_t valid_mask) const noexcept {
+    // Sign extended from the valid bits, so timestamps from before the calibration or across a wrap still work
+    const auto delta = (timestamp - _device_timestamp) & valid_mask;
+    const auto signed_delta = delta > valid_mask / 2 ? -static_cast<double>(valid_mask - delta + 1) : static_cast<double>(delta);
+    return (static_cast<double>(_host_ns) + signed_delta * _period_ns) / 1'000'000.0;
+}
+
+TimestampQueries::TimestampQueries()
+    :_device(nullptr)
+    ,_query_pool(nullptr)
+    ,_valid_mask(0)
+{}
+
+void TimestampQueries::destroy() noexcept {
+    if (_device) {
+        vkDestroyQueryPool(_device, _query_pool, nullptr);
+    }
+    _query_pool = nullptr;
+}
+
+void TimestampQueries::init(VkDevice device, VkPhysicalDevice physical_device, uint32_t queue_family, size_t num_frames) {
+    _device = device;
+    _written.assign(num_frames, false);
+
+    uint32_t num_queue_families;
+    vkGetPhysicalDeviceQueueFamilyProperties(physical_device, &num_queue_families, nullptr);
+    auto queue_family_props = std::make_unique_for_overwrite<VkQueueFamilyProperties[]>(num_queue_families);
+    vkGetPhysicalDeviceQueueFamilyProperties(physical_device, &num_queue_families, queue_family_props.get());
+
+    const auto valid_bits = queue_family_props[queue_family].timestampValidBits;
+    if (!valid_bits) {
+        return;
+    }
+    _valid_mask = valid_bits >= 64 ? UINT64_MAX : (uint64_t{1} << valid_bits) - 1;
+
+    const VkQueryPoolCreateInfo query_pool_create_info {
+        .sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO,
+        .queryType = VK_QUERY_TYPE_TIMESTAMP,
+        .queryCount = static_cast<uint32_t>(2 * num_frames)
+    };
+    check_success(vkCreateQueryPool(_device, &query_pool_create_info, nullptr, &_query_pool));
+}
+
+bool TimestampQueries::is_supported() const noexcept {
+    return !!_query_pool;
+}
+
+void TimestampQueries::write_begin(VkCommandBuffer command_buffer, size_t frame_index) noexcept {
+    if (!_query_pool) {
+        return;
+    }
+
+    const auto first_query = static_cast<uint32_t>(2 * frame_index);
+    vkCmdResetQueryPool(command_buffer, _query_pool, first_query, 2);
+    vkCmdWriteTimestamp2(command_buffer, VK_PIPELINE_STAGE_2_TOP_OF_PIPE_BIT, _query_pool, first_query);
+    _written[frame_index] = true;
+}
+
+void TimestampQueries::write_end(VkCommandBuffer command_buffer, size_t frame_index) noexcept {
+    if (!_query_pool) {
+        return;
+    }
+
+    vkCmdWriteTimestamp2(command_buffer, VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT, _query_pool, static_cast<uint32_t>(2 * frame_index + 1));
+}
+
+std::optional<GpuSpan> TimestampQueries::take_span(size_t frame_index, const TimestampCalibration& calibration) noexcept {
+    if (!_query_pool || !_written[frame_index] || !calibration.is_supported()) {
+        return std::nullopt;
+    }
+
+    std::array<uint64_t, 2> timestamps;
+    const auto result = vkGetQueryPoolResults(
+        _device, _query_pool, static_cast<uint32_t>(2 * frame_index), 2,
+        sizeof(timestamps), timestamps.data(), sizeof(uint64_t), VK_QUERY_RESULT_64_BIT
+    );
+    if (VK_SUCCESS != result) {
+        return std::nullopt;
+    }
+    _written[frame_index] = false;
+
+    return GpuSpan {
+        .begin_ms = calibration.to_host_ms(timestamps[0] & _valid_mask, _valid_mask),
+        .end_ms = calibration.to_host_ms(timestamps[1] & _valid_mask, _valid_mask)
+    };
+}
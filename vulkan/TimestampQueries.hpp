@@ -0,0 +1,68 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+
+#include <optional>
+#include <vector>
+
+// Host CLOCK_MONOTONIC, in milliseconds, so spans recorded on different queues can be compared
+struct GpuSpan {
+    double begin_ms, end_ms;
+};
+
+// Relates the device's timestamps to CLOCK_MONOTONIC with VK_EXT_calibrated_timestamps. Raw
+// timestamps written on different queues are not comparable, their host times are.
+class TimestampCalibration {
+public:
+    TimestampCalibration();
+
+    // Stays unsupported unless the extension is enabled and both clocks can be calibrated
+    void init(VkDevice device, VkPhysicalDevice physical_device, bool has_calibrated_timestamps);
+
+    bool is_supported() const noexcept;
+
+    // Samples both clocks again, so drift between them does not build up
+    void calibrate();
+    double to_host_ms(uint64_t timestamp, uint64_t valid_mask) const noexcept;
+
+private:
+    VkDevice _device;
+    bool _is_supported;
+    double _period_ns;
+
+    uint64_t _device_timestamp;
+    uint64_t _host_ns;
+};
+
+// A begin/end timestamp pair per frame in flight, recorded into one queue's command buffers
+class TimestampQueries {
+public:
+    TimestampQueries();
+    TimestampQueries(const TimestampQueries&) = delete;
+    TimestampQueries(TimestampQueries&&) noexcept = delete;
+    ~TimestampQueries() = default;
+
+    TimestampQueries& operator=(const TimestampQueries&) = delete;
+    TimestampQueries& operator=(TimestampQueries&&) noexcept = delete;
+
+    void destroy() noexcept;
+
+    void init(VkDevice device, VkPhysicalDevice physical_device, uint32_t queue_family, size_t num_frames);
+
+    // False if the queue family has no timestamp support, in which case nothing is recorded
+    bool is_supported() const noexcept;
+
+    void write_begin(VkCommandBuffer command_buffer, size_t frame_index) noexcept;
+    void write_end(VkCommandBuffer command_buffer, size_t frame_index) noexcept;
+
+    // Returns the frame's span once its command buffer has completed, at most once per write_begin(),
+    // and only if the calibration is supported
+    std::optional<GpuSpan> take_span(size_t frame_index, const TimestampCalibration& calibration) noexcept;
+
+private:
+    VkDevice _device;
+    VkQueryPool _query_pool;
+    uint64_t _valid_mask;
+
+    std::vector<bool> _written;
+};
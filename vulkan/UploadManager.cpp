@@ -0,0 +1,286 @@
+#include "UploadManager.hpp"
+
+#include "Common.hpp"
+
+#include <volk.h>
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include <utility>
+
+static constexpr VkDeviceSize STAGING_ALIGNMENT = 16;
+
+UploadManager::UploadManager()
+    :_device(nullptr)
+    ,_allocator(nullptr)
+    ,_queue(nullptr)
+    ,_queue_family(0)
+    ,_graphics_queue_family(0)
+    ,_command_pool(nullptr)
+    ,_timeline(nullptr)
+    ,_timeline_value(0)
+    ,_staging_buffer(nullptr)
+    ,_staging_allocation(nullptr)
+    ,_staging_data(nullptr)
+    ,_staging_capacity(0)
+    ,_staging_head(0)
+    ,_staging_tail(0)
+    ,_recording(nullptr)
+    ,_pending_acquire{}
+{}
+
+void UploadManager::destroy() noexcept {
+    if (!_device) {
+        return;
+    }
+
+    if (_timeline_value) {
+        const VkSemaphoreWaitInfo wait_info {
+            .sType = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO,
+            .semaphoreCount = 1,
+            .pSemaphores = &_timeline,
+            .pValues = &_timeline_value
+        };
+        vkWaitSemaphores(_device, &wait_info, UINT64_MAX);
+    }
+
+    vmaDestroyBuffer(_allocator, _staging_buffer, _staging_allocation);
+    vkDestroySemaphore(_device, _timeline, nullptr);
+    vkDestroyCommandPool(_device, _command_pool, nullptr);
+
+    _staging_buffer = nullptr;
+    _staging_allocation = nullptr;
+    _timeline = nullptr;
+    _command_pool = nullptr;
+    _recording = nullptr;
+    _in_flight.clear();
+    _free_command_buffers.clear();
+    _device = nullptr;
+}
+
+void UploadManager::init(
+    VkDevice device, VmaAllocator allocator, VkDeviceSize staging_capacity,
+    VkQueue transfer_queue, uint32_t transfer_queue_family, uint32_t graphics_queue_family
+) {
+    _device = device;
+    _allocator = allocator;
+    _queue = transfer_queue;
+    _queue_family = transfer_queue_family;
+    _graphics_queue_family = graphics_queue_family;
+    _staging_capacity = staging_capacity;
+
+    const VkCommandPoolCreateInfo command_pool_create_info {
+        .sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO,
+        .flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT | VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT,
+        .queueFamilyIndex = _queue_family
+    };
+    check_success(vkCreateCommandPool(_device, &command_pool_create_info, nullptr, &_command_pool));
+
+    const VkSemaphoreTypeCreateInfo timeline_type_create_info {
+        .sType = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO,
+        .semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE,
+        .initialValue = 0
+    };
+    const VkSemaphoreCreateInfo timeline_create_info {
+        .sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO,
+        .pNext = &timeline_type_create_info
+    };
+    check_success(vkCreateSemaphore(_device, &timeline_create_info, nullptr, &_timeline));
+
+    const VkBufferCreateInfo staging_buffer_create_info {
+        .sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
+        .size = _staging_capacity,
+        .usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT
+    };
+    const VmaAllocationCreateInfo staging_allocation_create_info {
+        .flags = VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT | VMA_ALLOCATION_CREATE_MAPPED_BIT,
+        .usage = VMA_MEMORY_USAGE_AUTO_PREFER_HOST,
+        .priority = STAGING_PRIORITY
+    };
+    VmaAllocationInfo staging_allocation_info;
+    check_success(vmaCreateBuffer(_allocator, &staging_buffer_create_info, &staging_allocation_create_info, &_staging_buffer, &_staging_allocation, &staging_allocation_info));
+    _staging_data = static_cast<uint8_t *>(staging_allocation_info.pMappedData);
+}
+
+void UploadManager::upload_buffer(VkBuffer dst_buffer, VkDeviceSize dst_offset, const void *data, VkDeviceSize size) {
+    const auto bytes = static_cast<const uint8_t *>(data);
+
+    // Uploads larger than the ring are split, flushing whenever it fills up
+    for (VkDeviceSize copied = 0; copied < size;) {
+        const auto chunk_size = std::min(size - copied, _staging_capacity);
+        const auto staging_offset = allocate_staging(chunk_size);
+        memcpy(_staging_data + staging_offset, bytes + copied, chunk_size);
+
+        const VkBufferCopy region {
+            .srcOffset = staging_offset,
+            .dstOffset = dst_offset + copied,
+            .size = chunk_size
+        };
+        vkCmdCopyBuffer(begin_recording(), _staging_buffer, dst_buffer, 1, &region);
+        copied += chunk_size;
+    }
+
+    if (_queue_family != _graphics_queue_family) {
+        _recorded_acquires.push_back({
+            .sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER_2,
+            .srcStageMask = VK_PIPELINE_STAGE_2_NONE,
+            .srcAccessMask = VK_ACCESS_2_NONE,
+            .dstStageMask = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT,
+            .dstAccessMask = VK_ACCESS_2_MEMORY_READ_BIT,
+            .srcQueueFamilyIndex = _queue_family,
+            .dstQueueFamilyIndex = _graphics_queue_family,
+            .buffer = dst_buffer,
+            .offset = dst_offset,
+            .size = size
+        });
+    }
+}
+
+void UploadManager::flush() {
+    if (!_recording) {
+        return;
+    }
+
+    // Release half of the ownership transfers, mirroring the acquires handed to the graphics queue
+    std::vector<VkBufferMemoryBarrier2> releases(_recorded_acquires);
+    for (auto& release : releases) {
+        release.srcStageMask = VK_PIPELINE_STAGE_2_COPY_BIT;
+        release.srcAccessMask = VK_ACCESS_2_TRANSFER_WRITE_BIT;
+        release.dstStageMask = VK_PIPELINE_STAGE_2_NONE;
+        release.dstAccessMask = VK_ACCESS_2_NONE;
+    }
+    if (!releases.empty()) {
+        const VkDependencyInfo dependency_info {
+            .sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO,
+            .bufferMemoryBarrierCount = static_cast<uint32_t>(releases.size()),
+            .pBufferMemoryBarriers = releases.data()
+        };
+        vkCmdPipelineBarrier2(_recording, &dependency_info);
+    }
+    check_success(vkEndCommandBuffer(_recording));
+    check_success(vmaFlushAllocation(_allocator, _staging_allocation, 0, VK_WHOLE_SIZE));
+
+    const auto timeline_value = _timeline_value + 1;
+    const VkCommandBufferSubmitInfo command_buffer_info {
+        .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_SUBMIT_INFO,
+        .commandBuffer = _recording
+    };
+    const VkSemaphoreSubmitInfo signal_semaphore_info {
+        .sType = VK_STRUCTURE_TYPE_SEMAPHORE_SUBMIT_INFO,
+        .semaphore = _timeline,
+        .value = timeline_value,
+        .stageMask = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT
+    };
+    const VkSubmitInfo2 submit_info {
+        .sType = VK_STRUCTURE_TYPE_SUBMIT_INFO_2,
+        .commandBufferInfoCount = 1,
+        .pCommandBufferInfos = &command_buffer_info,
+        .signalSemaphoreInfoCount = 1,
+        .pSignalSemaphoreInfos = &signal_semaphore_info
+    };
+    check_success(vkQueueSubmit2(_queue, 1, &submit_info, nullptr));
+    _timeline_value = timeline_value;
+
+    _in_flight.push_back({
+        .command_buffer = std::exchange(_recording, nullptr),
+        .timeline_value = timeline_value,
+        .staging_end = _staging_head
+    });
+
+    _pending_acquire.barriers.insert(_pending_acquire.barriers.end(), _recorded_acquires.begin(), _recorded_acquires.end());
+    _pending_acquire.timeline_value = timeline_value;
+    _recorded_acquires.clear();
+}
+
+VkSemaphore UploadManager::timeline() noexcept {
+    return _timeline;
+}
+
+PendingAcquire UploadManager::take_pending_acquire() {
+    retire_batches(false);
+    return std::exchange(_pending_acquire, {});
+}
+
+VkCommandBuffer UploadManager::begin_recording() {
+    if (_recording) {
+        return _recording;
+    }
+
+    if (_free_command_buffers.empty()) {
+        const VkCommandBufferAllocateInfo command_buffer_allocate_info {
+            .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO,
+            .commandPool = _command_pool,
+            .level = VK_COMMAND_BUFFER_LEVEL_PRIMARY,
+            .commandBufferCount = 1
+        };
+        check_success(vkAllocateCommandBuffers(_device, &command_buffer_allocate_info, &_recording));
+    } else {
+        _recording = _free_command_buffers.back();
+        _free_command_buffers.pop_back();
+        check_success(vkResetCommandBuffer(_recording, 0));
+    }
+
+    const VkCommandBufferBeginInfo command_buffer_begin_info {
+        .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
+        .flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT
+    };
+    check_success(vkBeginCommandBuffer(_recording, &command_buffer_begin_info));
+    return _recording;
+}
+
+VkDeviceSize UploadManager::allocate_staging(VkDeviceSize size) {
+    retire_batches(false);
+    while (true) {
+        if (_staging_tail == _staging_head) {
+            // Nothing is in flight, restart at the beginning of the ring so that any size fits
+            _staging_head = _staging_tail = (_staging_head + _staging_capacity - 1) / _staging_capacity * _staging_capacity;
+        }
+
+        auto position = (_staging_head + STAGING_ALIGNMENT - 1) / STAGING_ALIGNMENT * STAGING_ALIGNMENT;
+        // Allocations never wrap around the end of the ring, skip to the start instead
+        if (position % _staging_capacity + size > _staging_capacity) {
+            position += _staging_capacity - position % _staging_capacity;
+        }
+        if (position + size - _staging_tail <= _staging_capacity) {
+            _staging_head = position + size;
+            return position % _staging_capacity;
+        }
+
+        if (_in_flight.empty()) {
+            // Everything still occupying the ring was recorded into the current batch
+            flush();
+        }
+        retire_batches(true);
+    }
+}
+
+void UploadManager::retire_batches(bool wait) {
+    if (_in_flight.empty()) {
+        if (!_recording) {
+            _staging_tail = _staging_head;
+        }
+        return;
+    }
+
+    if (wait) {
+        const VkSemaphoreWaitInfo wait_info {
+            .sType = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO,
+            .semaphoreCount = 1,
+            .pSemaphores = &_timeline,
+            .pValues = &_in_flight.front().timeline_value
+        };
+        check_success(vkWaitSemaphores(_device, &wait_info, UINT64_MAX));
+    }
+
+    uint64_t completed_value;
+    check_success(vkGetSemaphoreCounterValue(_device, _timeline, &completed_value));
+    while (!_in_flight.empty() && _in_flight.front().timeline_value <= completed_value) {
+        _staging_tail = _in_flight.front().staging_end;
+        _free_command_buffers.push_back(_in_flight.front().command_buffer);
+        _in_flight.pop_front();
+    }
+    if (_in_flight.empty() && !_recording) {
+        _staging_tail = _staging_head;
+    }
+}
@@ -0,0 +1,81 @@
+#pragma once
+
+#include <vk_mem_alloc.h>
+
+#include <deque>
+#include <vector>
+
+// Uploads that have been submitted to the transfer queue and still need their ownership
+// acquired by the graphics queue. The graphics submission recording the barriers must
+// wait for the upload timeline to reach timeline_value.
+struct PendingAcquire {
+    std::vector<VkBufferMemoryBarrier2> barriers;
+    uint64_t timeline_value;
+};
+
+// Copies data into device local buffers through a persistently mapped staging ring on the
+// transfer queue. If the device has no dedicated transfer queue family the graphics queue is
+// used instead and no ownership transfers are needed.
+class UploadManager {
+public:
+    UploadManager();
+    UploadManager(const UploadManager&) = delete;
+    UploadManager(UploadManager&&) noexcept = delete;
+    ~UploadManager() = default;
+
+    UploadManager& operator=(const UploadManager&) = delete;
+    UploadManager& operator=(UploadManager&&) noexcept = delete;
+
+    // Waits for every submitted upload before destroying the staging ring
+    void destroy() noexcept;
+
+    void init(
+        VkDevice device, VmaAllocator allocator, VkDeviceSize staging_capacity,
+        VkQueue transfer_queue, uint32_t transfer_queue_family, uint32_t graphics_queue_family
+    );
+
+    // Records a copy into dst_buffer, blocking only if the staging ring is full of in-flight uploads.
+    // The buffer must have been created with TRANSFER_DST usage and not be in use by the device.
+    void upload_buffer(VkBuffer dst_buffer, VkDeviceSize dst_offset, const void *data, VkDeviceSize size);
+    // Submits the copies recorded since the last flush
+    void flush();
+
+    VkSemaphore timeline() noexcept;
+    // Returns barriers for everything flushed since the last call, with the timeline value to wait on
+    PendingAcquire take_pending_acquire();
+
+private:
+    struct Batch {
+        VkCommandBuffer command_buffer;
+        uint64_t timeline_value;
+        uint64_t staging_end;
+    };
+
+    VkCommandBuffer begin_recording();
+    VkDeviceSize allocate_staging(VkDeviceSize size);
+    void retire_batches(bool wait);
+
+private:
+    VkDevice _device;
+    VmaAllocator _allocator;
+    VkQueue _queue;
+    uint32_t _queue_family, _graphics_queue_family;
+
+    VkCommandPool _command_pool;
+    VkSemaphore _timeline;
+    uint64_t _timeline_value;
+
+    VkBuffer _staging_buffer;
+    VmaAllocation _staging_allocation;
+    uint8_t *_staging_data;
+    VkDeviceSize _staging_capacity;
+    // Positions only ever increase, the offset into the ring is the position modulo the capacity
+    uint64_t _staging_head, _staging_tail;
+
+    VkCommandBuffer _recording;
+    std::vector<VkBufferMemoryBarrier2> _recorded_acquires;
+    std::deque<Batch> _in_flight;
+    std::vector<VkCommandBuffer> _free_command_buffers;
+
+    PendingAcquire _pending_acquire;
+};
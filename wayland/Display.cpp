@@ -1,11 +1,15 @@
 #include "Display.hpp"
 
+#include "Environment.hpp"
+#include "EventLoop.hpp"
 #include "cursor/shape/ShapeCursorManager.hpp"
 #include "cursor/theme/ThemeCursorManager.hpp"
 
 #include <poll.h>
+#include <sys/epoll.h>
 
 #include <cstring>
+#include <utility>
 
 static constexpr uint32_t MINIMUM_WL_COMPOSITOR_VERSION = 4;
 static constexpr uint32_t DESIRED_WL_COMPOSITOR_VERSION = 6;
@@ -25,14 +29,27 @@ static constexpr uint32_t DESIRED_WP_CURSOR_SHAPE_V1_VERSION = 1;
 static constexpr uint32_t MINIMUM_WP_FRACTIONAL_SCALE_V1_VERSION = 1;
 static constexpr uint32_t DESIRED_WP_FRACTIONAL_SCALE_V1_VERSION = 1;
 
+static constexpr uint32_t MINIMUM_WP_PRESENTATION_VERSION = 1;
+static constexpr uint32_t DESIRED_WP_PRESENTATION_VERSION = 1;
+
 static constexpr uint32_t MINIMUM_WP_VIEWPORTER_VERSION = 1;
 static constexpr uint32_t DESIRED_WP_VIEWPORTER_VERSION = 1;
 
+static constexpr uint32_t MINIMUM_ZWP_POINTER_CONSTRAINTS_V1_VERSION = 1;
+static constexpr uint32_t DESIRED_ZWP_POINTER_CONSTRAINTS_V1_VERSION = 1;
+
+static constexpr uint32_t MINIMUM_ZWP_RELATIVE_POINTER_V1_VERSION = 1;
+static constexpr uint32_t DESIRED_ZWP_RELATIVE_POINTER_V1_VERSION = 1;
+
 static constexpr uint32_t MINIMUM_XDG_DECORATION_V1_VERSION = 1;
 static constexpr uint32_t DESIRED_XDG_DECORATION_V1_VERSION = 1;
 
 static constexpr uint32_t MINIMUM_XDG_SHELL_VERSION = 2;
+#ifdef XDG_TOPLEVEL_STATE_SUSPENDED_SINCE_VERSION
+static constexpr uint32_t DESIRED_XDG_SHELL_VERSION = XDG_TOPLEVEL_STATE_SUSPENDED_SINCE_VERSION;
+#else
 static constexpr uint32_t DESIRED_XDG_SHELL_VERSION = 4;
+#endif
 
 static short poll_single(int fd, short events, int timeout) {
     pollfd pfd { .fd = fd, .events = events, .revents = 0 };
@@ -48,7 +65,13 @@ static T *do_bind(wl_registry *wl_registry, uint32_t name, uint32_t version, con
     return static_cast<T *>(wl_registry_bind(wl_registry, name, interface, std::min(version, desired_version)));
 }
 
-Display::Display() {
+Display::Display()
+    :_constrained_surface(nullptr)
+    ,_pointer_constraint(PointerConstraint::None)
+    ,_presentation_clock(CLOCK_MONOTONIC)
+    ,_loop(nullptr)
+    ,_fd_events(0)
+{
     static constexpr wl_registry_listener registry_listener {
         .global = [](void *data, wl_registry *wl_registry, uint32_t name, const char *interface, uint32_t version) noexcept {
             auto& self = *static_cast<Display*>(data);
@@ -89,6 +112,15 @@ Display::Display() {
                     DESIRED_WP_FRACTIONAL_SCALE_V1_VERSION
                 ));
             }
+            else if (!strcmp(wp_presentation_interface.name, interface)
+                && version >= MINIMUM_WP_PRESENTATION_VERSION)
+            {
+                self._presentation.reset(do_bind<wp_presentation>(
+                    wl_registry, name, version,
+                    &wp_presentation_interface,
+                    DESIRED_WP_PRESENTATION_VERSION
+                ));
+            }
             else if (!strcmp(wp_viewporter_interface.name, interface)
                 && version >= MINIMUM_WP_VIEWPORTER_VERSION)
             {
@@ -134,6 +166,26 @@ Display::Display() {
                     DESIRED_XDG_SHELL_VERSION
                 ));
             }
+            else if (!strcmp(zwp_pointer_constraints_v1_interface.name, interface)
+                && version >= MINIMUM_ZWP_POINTER_CONSTRAINTS_V1_VERSION)
+            {
+                self._pointer_constraints.reset(do_bind<zwp_pointer_constraints_v1>(
+                    wl_registry, name, version,
+                    &zwp_pointer_constraints_v1_interface,
+                    DESIRED_ZWP_POINTER_CONSTRAINTS_V1_VERSION
+                ));
+            }
+            else if (!strcmp(zwp_relative_pointer_manager_v1_interface.name, interface)
+                && version >= MINIMUM_ZWP_RELATIVE_POINTER_V1_VERSION)
+            {
+                self._relative_pointer_manager.reset(do_bind<zwp_relative_pointer_manager_v1>(
+                    wl_registry, name, version,
+                    &zwp_relative_pointer_manager_v1_interface,
+                    DESIRED_ZWP_RELATIVE_POINTER_V1_VERSION
+                ));
+                // Relative pointers created from it inherit the queue, so their events join the pointer frames
+                wl_proxy_set_queue(reinterpret_cast<wl_proxy *>(self._relative_pointer_manager.get()), self._input_thread->queue());
+            }
             else if (!strcmp(zxdg_decoration_manager_v1_interface.name, interface)
                 && version >= MINIMUM_XDG_DECORATION_V1_VERSION)
             {
@@ -145,12 +197,20 @@ Display::Display() {
         },
         .global_remove = [](void *data, wl_registry *, uint32_t name) noexcept {
             auto& self = *static_cast<Display*>(data);
+            const auto lock = self._input_thread->lock_dispatch();
             self._seats.remove_if([name](Seat& seat){
                 return seat.global_name() == name;
             });
         }
     };
 
+    static constexpr wp_presentation_listener presentation_listener {
+        .clock_id = [](void *data, wp_presentation *, uint32_t clk_id) noexcept {
+            auto& self = *static_cast<Display*>(data);
+            self._presentation_clock = static_cast<clockid_t>(clk_id);
+        }
+    };
+
     static constexpr xdg_wm_base_listener wm_base_listener {
         .ping = [](void *, xdg_wm_base *wm_base, uint32_t serial) noexcept {
             xdg_wm_base_pong(wm_base, serial);
@@ -162,6 +222,11 @@ Display::Display() {
         throw std::runtime_error("No wayland compositor detected");
     }
 
+    if (get_env_flag("WAYLAND_EXAMPLE_EVENT_THREAD")) {
+        _shell_thread.emplace(_display.get());
+    }
+    _input_thread.emplace(_display.get());
+
     _registry.reset(wl_display_get_registry(_display.get()));
     wl_registry_add_listener(_registry.get(), &registry_listener, this);
     wl_display_roundtrip(_display.get());
@@ -171,6 +236,14 @@ Display::Display() {
     }
 
     xdg_wm_base_add_listener(_wm_base.get(), &wm_base_listener, this);
+    // Surfaces created from it inherit the queue
+    use_shell_queue(_wm_base.get());
+
+    if (_presentation) {
+        // clock_id is sent right after binding, fetch it before any window asks for feedback
+        wp_presentation_add_listener(_presentation.get(), &presentation_listener, this);
+        wl_display_roundtrip(_display.get());
+    }
 
     if (!_cursor_manager) {
         _cursor_manager = std::make_unique<ThemeCursorManager>(_compositor.get(), _shm.get());
@@ -181,7 +254,41 @@ Display::Display() {
     _has_fractional_scale = _fractional_scale_manager && _viewporter;
 }
 
-void Display::poll_events() {
+Display::~Display() {
+    detach();
+}
+
+void Display::attach(EventLoop& loop) {
+    _loop = &loop;
+    loop.add_fd(wl_display_get_fd(_display.get()), EPOLLIN, [this](uint32_t events) {
+        _fd_events |= events;
+    });
+    _input_thread->start(loop);
+    if (_shell_thread) {
+        // The window picks up what the listeners recorded once the loop wakes
+        _shell_thread->start([&loop](int num_events) {
+            if (num_events) {
+                loop.wake();
+            }
+        });
+    }
+}
+
+void Display::detach() noexcept {
+    // Both threads wake the loop from their callbacks
+    if (_input_thread) {
+        _input_thread->stop();
+    }
+    if (_shell_thread) {
+        _shell_thread->stop();
+    }
+    if (_loop) {
+        _loop->remove_fd(wl_display_get_fd(_display.get()));
+        _loop = nullptr;
+    }
+}
+
+void Display::prepare_read() {
     while (wl_display_prepare_read(_display.get())) {
         wl_display_dispatch_pending(_display.get());
     }
@@ -189,15 +296,49 @@ void Display::poll_events() {
     while (wl_display_flush(_display.get()) < 0 && EAGAIN == errno) {
         poll_single(wl_display_get_fd(_display.get()), POLLOUT, -1);
     }
+}
+
+void Display::read_events() {
+    const auto events = std::exchange(_fd_events, 0);
+    if (events & (EPOLLERR | EPOLLHUP)) {
+        wl_display_cancel_read(_display.get());
+        throw std::runtime_error("Wayland connection lost");
+    }
 
-    if (POLLIN & poll_single(wl_display_get_fd(_display.get()), POLLIN, 0)) {
+    if (events & EPOLLIN) {
         wl_display_read_events(_display.get());
-        wl_display_dispatch_pending(_display.get());
     } else {
         wl_display_cancel_read(_display.get());
     }
+    wl_display_dispatch_pending(_display.get());
 
     if (wl_display_get_error(_display.get())) {
         throw std::runtime_error("Wayland protocol error");
-    }    
+    }
+
+    _input_thread->deliver();
+}
+
+InputStatistics Display::input_statistics() const noexcept {
+    return _input_thread->statistics();
+}
+
+void Display::constrain_pointers(wl_surface *surface, PointerConstraint constraint) {
+    // Pointers are created and destroyed by listeners on the input thread
+    const auto lock = _input_thread->lock_dispatch();
+    _constrained_surface = constraint == PointerConstraint::None ? nullptr : surface;
+    _pointer_constraint = constraint;
+    for (auto& seat : _seats) {
+        seat.constrain_pointer(surface, constraint);
+    }
+}
+
+void Display::use_shell_queue(void *proxy) noexcept {
+    if (_shell_thread) {
+        wl_proxy_set_queue(static_cast<wl_proxy *>(proxy), _shell_thread->queue());
+    }
+}
+
+std::unique_lock<std::mutex> Display::lock_shell_dispatch() {
+    return _shell_thread ? _shell_thread->lock_dispatch() : std::unique_lock<std::mutex>{};
 }
@@ -1,46 +1,106 @@
 #pragma once
 
 #include "cursor/CursorManagerBase.hpp"
+#include "EventThread.hpp"
+#include "InputThread.hpp"
 #include "Seat.hpp"
 #include "XkbPointer.hpp"
 
 #include <forward_list>
+#include <optional>
+#include <stdexcept>
 
+#include <time.h>
+
+class EventLoop;
 class Seat;
 class Display {
     friend class Keyboard;
     friend class Pointer;
     friend class Seat;
+    friend class Touch;
     friend class Window;
 public:
     Display();
     Display(const Display&) = delete;
     Display(Display&&) noexcept = delete;
-    ~Display() = default;
+    ~Display();
 
     Display& operator=(const Display&) = delete;
     Display& operator=(Display&&) noexcept = delete;
 
-    void poll_events();
+    // Registers the wayland fd with the loop and starts the event threads, must be called before prepare_read()
+    void attach(EventLoop& loop);
+    // Stops the event threads and unregisters the wayland fd, must be called before the loop is destroyed
+    void detach() noexcept;
+
+    // Dispatches already queued events and flushes requests before the loop sleeps
+    void prepare_read();
+    // Reads and dispatches events if the loop saw the wayland fd become readable, then delivers
+    // any input the input thread has queued since
+    void read_events();
+
+    InputStatistics input_statistics() const noexcept;
+
+private:
+    // Replaces the constraint on every seat's pointer over the surface, and on pointers created later
+    void constrain_pointers(wl_surface *surface, PointerConstraint constraint);
+    // Moves a shell object to the shell thread's queue, if there is one. Only safe while nothing
+    // else can dispatch its events, use create_on_shell_queue() for objects created afterwards.
+    void use_shell_queue(void *proxy) noexcept;
+    // Calls create with the factory, or with a wrapper of it on the shell thread's queue if there is
+    // one, so the new object's events are never dispatched from the default queue
+    template<typename T, typename F>
+    auto create_on_shell_queue(T *factory, F&& create) {
+        if (!_shell_thread) {
+            return create(factory);
+        }
+
+        const auto wrapper = static_cast<T *>(wl_proxy_create_wrapper(factory));
+        if (!wrapper) {
+            throw std::runtime_error("Unable to create wayland proxy wrapper");
+        }
+        wl_proxy_set_queue(reinterpret_cast<wl_proxy *>(wrapper), _shell_thread->queue());
+        const auto ret = create(wrapper);
+        wl_proxy_wrapper_destroy(wrapper);
+        return ret;
+    }
+    // Empty if shell objects are dispatched with the default queue
+    std::unique_lock<std::mutex> lock_shell_dispatch();
 
 private:
     WaylandPointer<wl_display> _display;
     WaylandPointer<wl_registry> _registry;
+    // Optionally dispatches xdg_wm_base and the window's shell objects, so a long frame never delays
+    // answering pings or receiving configures. Declared early so it outlives the proxies on its queue.
+    std::optional<EventThread> _shell_thread;
 
     WaylandPointer<wl_compositor> _compositor;
     WaylandPointer<xdg_wm_base> _wm_base;
 
     std::unique_ptr<CursorManagerBase> _cursor_manager;
+    // Seats and their input objects are dispatched on the input thread, which is stopped before they are destroyed
+    std::optional<InputThread> _input_thread;
     std::forward_list<Seat> _seats;
+    // Last constraint set by constrain_pointers(), null once released. Only accessed with the input
+    // thread's dispatch lock held, which is also held while new pointers are created.
+    wl_surface *_constrained_surface;
+    PointerConstraint _pointer_constraint;
 
     // Optional protocols
     WaylandPointer<wl_shm> _shm; // Only needed for wl-cursor theme cursors
     WaylandPointer<wp_content_type_manager_v1> _content_type_manager;
     WaylandPointer<wp_fractional_scale_manager_v1> _fractional_scale_manager;
+    WaylandPointer<wp_presentation> _presentation;
     WaylandPointer<wp_viewporter> _viewporter;
+    WaylandPointer<zwp_pointer_constraints_v1> _pointer_constraints;
+    WaylandPointer<zwp_relative_pointer_manager_v1> _relative_pointer_manager;
     WaylandPointer<zxdg_decoration_manager_v1> _decoration_manager;
 
     XkbPointer<xkb_context> _xkb_context;
 
     bool _has_fractional_scale;
+    clockid_t _presentation_clock;
+    EventLoop *_loop;
+    uint32_t _fd_events;
 };
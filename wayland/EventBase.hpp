@@ -1,10 +0,0 @@
-#pragma once
-
-#include <string>
-
-class EventBase {
-public:
-    virtual ~EventBase() = default;
-
-    virtual std::string to_string() const  = 0;
-};
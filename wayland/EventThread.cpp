@@ -0,0 +1,114 @@
+#include "EventThread.hpp"
+
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+#include <array>
+#include <cerrno>
+#include <stdexcept>
+#include <utility>
+
+static constexpr int BAD_FD = -1;
+
+EventThread::EventThread(wl_display *display)
+    :_display(display)
+    ,_queue(wl_display_create_queue(display))
+    ,_stop_fd(BAD_FD)
+{
+    if (!_queue) {
+        throw std::runtime_error("Unable to create wayland event queue");
+    }
+
+    _stop_fd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    if (_stop_fd < 0) {
+        throw std::runtime_error("Unable to create event thread eventfd");
+    }
+}
+
+EventThread::~EventThread() {
+    stop();
+    close(_stop_fd);
+}
+
+wl_event_queue *EventThread::queue() noexcept {
+    return _queue.get();
+}
+
+void EventThread::start(DispatchCallback callback) {
+    _callback = std::move(callback);
+    _thread = std::thread(&EventThread::thread_entry, this);
+}
+
+void EventThread::stop() noexcept {
+    if (_thread.joinable()) {
+        const uint64_t value = 1;
+        [[maybe_unused]] const auto written = write(_stop_fd, &value, sizeof(value));
+        _thread.join();
+    }
+}
+
+std::unique_lock<std::mutex> EventThread::lock_dispatch() {
+    return std::unique_lock{ _dispatch_mutex };
+}
+
+bool EventThread::dispatch_pending() noexcept {
+    int num_events;
+    {
+        const auto lock = lock_dispatch();
+        num_events = wl_display_dispatch_queue_pending(_display, _queue.get());
+    }
+    if (num_events < 0) {
+        return false;
+    }
+
+    if (_callback) {
+        _callback(num_events);
+    }
+    return true;
+}
+
+// Whichever thread reads the socket sorts the events into their queues, and each thread only
+// dispatches its own. Connection errors are left for the thread dispatching the default queue
+// to report.
+void EventThread::thread_entry() noexcept {
+    const auto display_fd = wl_display_get_fd(_display);
+
+    while (true) {
+        while (wl_display_prepare_read_queue(_display, _queue.get())) {
+            if (!dispatch_pending()) {
+                return;
+            }
+        }
+        // Listeners may have sent requests, such as cursor updates or pongs
+        wl_display_flush(_display);
+
+        std::array fds {
+            pollfd { .fd = display_fd, .events = POLLIN, .revents = 0 },
+            pollfd { .fd = _stop_fd, .events = POLLIN, .revents = 0 }
+        };
+        if (poll(fds.data(), fds.size(), -1) < 0) {
+            wl_display_cancel_read(_display);
+            if (EINTR == errno) {
+                continue;
+            }
+            return;
+        }
+
+        if (fds[1].revents || (fds[0].revents & (POLLERR | POLLHUP))) {
+            wl_display_cancel_read(_display);
+            return;
+        }
+        if (fds[0].revents & POLLIN) {
+            if (wl_display_read_events(_display) < 0) {
+                return;
+            }
+        } else {
+            wl_display_cancel_read(_display);
+        }
+
+        if (!dispatch_pending()) {
+            return;
+        }
+    }
+}
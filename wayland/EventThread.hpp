@@ -0,0 +1,43 @@
+#pragma once
+
+#include "WaylandPointer.hpp"
+
+#include <functional>
+#include <mutex>
+#include <thread>
+
+// Reads the display and dispatches one event queue on its own thread, alongside whichever threads
+// dispatch the others. Proxies are moved onto the queue with wl_proxy_set_queue(), and proxies
+// created from them inherit it.
+class EventThread {
+public:
+    // Called on the thread after every dispatch, with the number of events dispatched
+    using DispatchCallback = std::function<void(int num_events)>;
+
+    explicit EventThread(wl_display *display);
+    EventThread(const EventThread&) = delete;
+    EventThread(EventThread&&) noexcept = delete;
+    ~EventThread();
+
+    EventThread& operator=(const EventThread&) = delete;
+    EventThread& operator=(EventThread&&) noexcept = delete;
+
+    wl_event_queue *queue() noexcept;
+
+    void start(DispatchCallback callback);
+    void stop() noexcept;
+    // Held while listeners run, so their objects can be destroyed from other threads
+    std::unique_lock<std::mutex> lock_dispatch();
+
+private:
+    bool dispatch_pending() noexcept;
+    void thread_entry() noexcept;
+
+private:
+    wl_display *_display;
+    WaylandPointer<wl_event_queue> _queue;
+    int _stop_fd;
+    std::thread _thread;
+    std::mutex _dispatch_mutex;
+    DispatchCallback _callback;
+};
@@ -0,0 +1,67 @@
+#include "FrameScheduler.hpp"
+
+#include <algorithm>
+#include <limits>
+
+FrameScheduler::FrameScheduler(wl_surface *surface)
+    :_surface(surface)
+    ,_timestamps{}
+    ,_num_timestamps(0)
+{}
+
+void FrameScheduler::arm() {
+    static constexpr wl_callback_listener callback_listener {
+        .done = [](void *data, wl_callback *, uint32_t callback_data) noexcept {
+            auto& self = *static_cast<FrameScheduler *>(data);
+
+            self._timestamps[self._num_timestamps % self._timestamps.size()] = callback_data;
+            ++self._num_timestamps;
+            self._callback.reset();
+        }
+    };
+
+    _callback.reset(wl_surface_frame(_surface));
+    wl_callback_add_listener(_callback.get(), &callback_listener, this);
+}
+
+void FrameScheduler::cancel() noexcept {
+    _callback.reset();
+}
+
+bool FrameScheduler::callback_pending() const noexcept {
+    return !!_callback;
+}
+
+std::vector<uint32_t> FrameScheduler::callback_timestamps() const {
+    const auto count = std::min(_num_timestamps, _timestamps.size());
+
+    std::vector<uint32_t> ret;
+    ret.reserve(count);
+    for (size_t i = _num_timestamps - count; i < _num_timestamps; ++i) {
+        ret.push_back(_timestamps[i % _timestamps.size()]);
+    }
+    return ret;
+}
+
+FrameTimeStatistics FrameScheduler::statistics() const noexcept {
+    const auto count = std::min(_num_timestamps, _timestamps.size());
+    if (count < 2) {
+        return {};
+    }
+
+    FrameTimeStatistics ret {
+        .num_frames = static_cast<uint32_t>(count - 1),
+        .min_ms = std::numeric_limits<double>::max(),
+        .average_ms = 0.0,
+        .max_ms = 0.0
+    };
+    for (size_t i = _num_timestamps - count + 1; i < _num_timestamps; ++i) {
+        // Unsigned subtraction handles the 32-bit millisecond clock wrapping
+        const auto delta = static_cast<double>(_timestamps[i % _timestamps.size()] - _timestamps[(i - 1) % _timestamps.size()]);
+        ret.min_ms = std::min(ret.min_ms, delta);
+        ret.max_ms = std::max(ret.max_ms, delta);
+        ret.average_ms += delta;
+    }
+    ret.average_ms /= ret.num_frames;
+    return ret;
+}
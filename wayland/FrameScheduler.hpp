@@ -0,0 +1,45 @@
+#pragma once
+
+#include "WaylandPointer.hpp"
+
+#include <array>
+#include <vector>
+
+inline constexpr size_t FRAME_TIMESTAMP_HISTORY = 128;
+
+struct FrameTimeStatistics {
+    uint32_t num_frames;
+    double min_ms, average_ms, max_ms;
+};
+
+// Throttles rendering to wl_surface.frame callbacks. The compositor only
+// signals a callback once it wants a new frame, so nothing is drawn while
+// a frame is still queued or the surface is not visible.
+class FrameScheduler {
+public:
+    explicit FrameScheduler(wl_surface *surface);
+    FrameScheduler(const FrameScheduler&) = delete;
+    FrameScheduler(FrameScheduler&&) noexcept = delete;
+    ~FrameScheduler() = default;
+
+    FrameScheduler& operator=(const FrameScheduler&) = delete;
+    FrameScheduler& operator=(FrameScheduler&&) noexcept = delete;
+
+    // Requests a callback for the next commit of the surface
+    void arm();
+    // Forgets the pending callback, for when the commit it was meant for never happened
+    void cancel() noexcept;
+
+    bool callback_pending() const noexcept;
+
+    // Compositor timestamps (in milliseconds) of the most recent callbacks, oldest first
+    std::vector<uint32_t> callback_timestamps() const;
+    FrameTimeStatistics statistics() const noexcept;
+
+private:
+    wl_surface *_surface;
+    WaylandPointer<wl_callback> _callback;
+
+    std::array<uint32_t, FRAME_TIMESTAMP_HISTORY> _timestamps;
+    size_t _num_timestamps;
+};
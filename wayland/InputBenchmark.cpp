@@ -0,0 +1,114 @@
+#include "InputEvent.hpp"
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <new>
+#include <string>
+#include <vector>
+
+// One motion per frame like a 1000 Hz mouse, with the occasional scroll and click
+static constexpr uint32_t EVENT_RATE_HZ = 1000;
+static constexpr uint32_t WARMUP_SECONDS = 1;
+static constexpr uint32_t BENCHMARK_SECONDS = 10;
+static constexpr uint32_t AXIS_INTERVAL = 10;
+static constexpr uint32_t BUTTON_INTERVAL = 250;
+static constexpr size_t MAX_EVENT_STRING_LENGTH = 128;
+
+// Counts every allocation made by the program. Replacing the global operator new is the only way
+// to see allocations made inside the standard library, which is why the benchmark is an executable
+// of its own instead of a mode of the example.
+static std::atomic<uint64_t> num_allocations;
+
+void *operator new(size_t size) {
+    num_allocations.fetch_add(1, std::memory_order_relaxed);
+    if (const auto ret = std::malloc(size ? size : 1)) {
+        return ret;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void *p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void *p, size_t) noexcept {
+    std::free(p);
+}
+
+template<typename F>
+static void generate_frames(uint32_t first_frame, uint32_t num_frames, F&& frame) {
+    for (uint32_t i = first_frame; i < first_frame + num_frames; ++i) {
+        std::array<PointerEvent, 3> events;
+        size_t num_events = 0;
+        events[num_events++] = PointerMotionEvent{ i, i % 800 + 0.5, i / 800 % 600 + 0.5, 0, 0 };
+        if (i % AXIS_INTERVAL == 0) {
+            events[num_events++] = PointerAxisEvent{ i, 10.0, false };
+        }
+        if (i % BUTTON_INTERVAL == 0) {
+            events[num_events++] = PointerButtonEvent{ i, i, 0, i / BUTTON_INTERVAL % 2 == 0 };
+        }
+        frame(std::span<const PointerEvent>(events.data(), num_events));
+    }
+}
+
+// Prints the allocations and time per event of the frames after the warmup
+template<typename F>
+static void run(const char *name, F&& frame) {
+    generate_frames(0, WARMUP_SECONDS * EVENT_RATE_HZ, frame);
+
+    size_t num_events = 0;
+    const auto allocations_begin = num_allocations.load(std::memory_order_relaxed);
+    const auto begin = std::chrono::steady_clock::now();
+    generate_frames(WARMUP_SECONDS * EVENT_RATE_HZ, BENCHMARK_SECONDS * EVENT_RATE_HZ, [&](std::span<const PointerEvent> events) {
+        num_events += events.size();
+        frame(events);
+    });
+    const std::chrono::duration<double, std::nano> time = std::chrono::steady_clock::now() - begin;
+    const auto allocations = num_allocations.load(std::memory_order_relaxed) - allocations_begin;
+
+    std::printf("  %-14s %8.1f allocations per second of input, %6.1fns/event\n",
+        name, static_cast<double>(allocations) / BENCHMARK_SECONDS, time.count() / static_cast<double>(num_events));
+}
+
+// Feeds a simulated 1000 Hz mouse through heap allocated events and through the value type events
+// the seat uses, and prints the allocations per second of input and the cost per event of each
+int main() {
+    std::printf("%u Hz pointer over %u seconds:\n", EVENT_RATE_HZ, BENCHMARK_SECONDS);
+
+    // What the seat used to do: one heap object per event, described as a std::string
+    size_t boxed_length = 0;
+    std::vector<std::unique_ptr<PointerEvent>> boxed_events;
+    run("Heap events", [&](std::span<const PointerEvent> events) {
+        for (const auto& event : events) {
+            boxed_events.push_back(std::make_unique<PointerEvent>(event));
+        }
+        for (const auto& event : boxed_events) {
+            std::string str(MAX_EVENT_STRING_LENGTH, '\0');
+            str.resize(format_event(str, *event));
+            boxed_length += str.size();
+        }
+        boxed_events.clear();
+    });
+
+    // The buffer is cleared, not freed, between frames and events are described on the stack
+    size_t value_length = 0;
+    std::vector<PointerEvent> value_events;
+    run("Value events", [&](std::span<const PointerEvent> events) {
+        value_events.insert(value_events.end(), events.begin(), events.end());
+        for (const auto& event : value_events) {
+            std::array<char, MAX_EVENT_STRING_LENGTH> str;
+            value_length += format_event(str, event);
+        }
+        value_events.clear();
+    });
+
+    if (boxed_length != value_length) {
+        std::fprintf(stderr, "Event descriptions differ: %zu and %zu characters\n", boxed_length, value_length);
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,69 @@
+#include "InputEvent.hpp"
+
+#include <algorithm>
+#include <cstdio>
+
+template<typename... Args>
+static size_t format(std::span<char> buffer, const char *format, Args... args) noexcept {
+    if (buffer.empty()) {
+        return 0;
+    }
+    const auto ret = std::snprintf(buffer.data(), buffer.size(), format, args...);
+    return ret < 0 ? 0 : std::min(static_cast<size_t>(ret), buffer.size() - 1);
+}
+
+static size_t format(std::span<char> buffer, const PointerEnterEvent& event) noexcept {
+    return format(buffer, "Enter (serial: %u, pos: (%.2f, %.2f))", event.serial, event.x, event.y);
+}
+
+static size_t format(std::span<char> buffer, const PointerLeaveEvent& event) noexcept {
+    return format(buffer, "Leave (serial: %u)", event.serial);
+}
+
+static size_t format(std::span<char> buffer, const PointerMotionEvent& event) noexcept {
+    if (event.num_coalesced) {
+        return format(buffer, "Motion (time: %u, pos: (%.2f, %.2f), coalesced: %u)", event.time, event.x, event.y, event.num_coalesced);
+    }
+    return format(buffer, "Motion (time: %u, pos: (%.2f, %.2f))", event.time, event.x, event.y);
+}
+
+static size_t format(std::span<char> buffer, const PointerRelativeMotionEvent& event) noexcept {
+    return format(buffer, "Relative motion (utime: %llu, delta: (%.2f, %.2f), unaccelerated: (%.2f, %.2f))",
+        static_cast<unsigned long long>(event.utime), event.dx, event.dy, event.dx_unaccelerated, event.dy_unaccelerated);
+}
+
+static size_t format(std::span<char> buffer, const PointerButtonEvent& event) noexcept {
+    return format(buffer, "Button (serial: %u, time: %u, button: %u, pressed: %d)", event.serial, event.time, event.button, event.pressed);
+}
+
+static size_t format(std::span<char> buffer, const PointerAxisEvent& event) noexcept {
+    return format(buffer, "Axis (time: %u, value: %.2f, horizontal: %d)", event.time, event.value, event.horizontal);
+}
+
+static size_t format(std::span<char> buffer, const TouchDownEvent& event) noexcept {
+    return format(buffer, "Down (serial: %u, time: %u, pos: (%.2f, %.2f))", event.serial, event.time, event.x, event.y);
+}
+
+static size_t format(std::span<char> buffer, const TouchUpEvent& event) noexcept {
+    return format(buffer, "Up (serial: %u, time: %u)", event.serial, event.time);
+}
+
+static size_t format(std::span<char> buffer, const TouchMotionEvent& event) noexcept {
+    return format(buffer, "Motion (time: %u, pos: (%.2f, %.2f))", event.time, event.x, event.y);
+}
+
+static size_t format(std::span<char> buffer, const TouchShapeEvent& event) noexcept {
+    return format(buffer, "Shape (size: (%.2f, %.2f))", event.major, event.minor);
+}
+
+static size_t format(std::span<char> buffer, const TouchOrientationEvent& event) noexcept {
+    return format(buffer, "Orientation (angle: %.2f degrees)", event.angle);
+}
+
+size_t format_event(std::span<char> buffer, const PointerEvent& event) noexcept {
+    return std::visit([buffer](const auto& e) noexcept { return format(buffer, e); }, event);
+}
+
+size_t format_event(std::span<char> buffer, const TouchEvent& event) noexcept {
+    return std::visit([buffer](const auto& e) noexcept { return format(buffer, e); }, event);
+}
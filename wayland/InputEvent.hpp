@@ -0,0 +1,96 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <variant>
+
+// Input events are plain values, so a frame's worth of them lives in a vector that is cleared,
+// not freed, between frames and a steady stream of input allocates nothing.
+// Positions are in surface local coordinates, kept at the full precision of the protocol's 24.8
+// fixed point values rather than rounded to whole pixels.
+
+struct PointerEnterEvent {
+    uint32_t serial;
+    double x, y;
+};
+
+struct PointerLeaveEvent {
+    uint32_t serial;
+};
+
+struct PointerMotionEvent {
+    uint32_t time;
+    double x, y;
+    // When motion is coalesced, the earlier samples this event replaced, oldest first, are
+    // motion_history[first_coalesced, first_coalesced + num_coalesced) of its frame
+    uint32_t first_coalesced, num_coalesced;
+};
+
+// From zwp_relative_pointer_v1, sent even while the pointer is locked and so no longer moves
+struct PointerRelativeMotionEvent {
+    // Microseconds with an undefined base, only comparable with the utime of other relative motion
+    uint64_t utime;
+    // Deltas in surface local coordinates after pointer acceleration
+    double dx, dy;
+    // Deltas as reported by the device, for uses such as mouse look that apply their own sensitivity
+    double dx_unaccelerated, dy_unaccelerated;
+};
+
+struct PointerButtonEvent {
+    uint32_t serial;
+    uint32_t time;
+    uint32_t button;
+    bool pressed;
+};
+
+struct PointerAxisEvent {
+    uint32_t time;
+    double value;
+    bool horizontal;
+};
+
+using PointerEvent = std::variant<PointerEnterEvent, PointerLeaveEvent, PointerMotionEvent, PointerRelativeMotionEvent, PointerButtonEvent, PointerAxisEvent>;
+
+struct TouchDownEvent {
+    uint32_t serial;
+    uint32_t time;
+    double x, y;
+};
+
+struct TouchUpEvent {
+    uint32_t serial;
+    uint32_t time;
+};
+
+struct TouchMotionEvent {
+    uint32_t time;
+    double x, y;
+};
+
+struct TouchShapeEvent {
+    double major, minor;
+};
+
+struct TouchOrientationEvent {
+    // Degrees
+    double angle;
+};
+
+using TouchEvent = std::variant<TouchDownEvent, TouchUpEvent, TouchMotionEvent, TouchShapeEvent, TouchOrientationEvent>;
+
+struct KeysymEvent {
+    uint32_t keysym;
+    bool shift, ctrl, alt;
+};
+
+// UTF-8 produced by a single key press, not null terminated
+struct TextEvent {
+    std::array<char, 16> text;
+    uint32_t length;
+};
+
+// Writes a null terminated description of the event, truncated to fit the buffer, and returns its length
+size_t format_event(std::span<char> buffer, const PointerEvent& event) noexcept;
+size_t format_event(std::span<char> buffer, const TouchEvent& event) noexcept;
@@ -0,0 +1,121 @@
+#include "InputThread.hpp"
+
+#include "Window.hpp"
+
+#include "EventLoop.hpp"
+
+#include <algorithm>
+#include <string_view>
+#include <utility>
+
+InputThread::InputThread(wl_display *display)
+    :_thread(display)
+    ,_num_dropped(0)
+    ,_pushed(false)
+    ,_statistics{}
+{}
+
+InputThread::~InputThread() {
+    // The thread pushes into members destroyed before it
+    stop();
+}
+
+wl_event_queue *InputThread::queue() noexcept {
+    return _thread.queue();
+}
+
+void InputThread::start(EventLoop& loop) {
+    _thread.start([this, &loop](int) {
+        if (std::exchange(_pushed, false)) {
+            loop.wake();
+        }
+    });
+}
+
+void InputThread::stop() noexcept {
+    _thread.stop();
+}
+
+std::unique_lock<std::mutex> InputThread::lock_dispatch() {
+    return _thread.lock_dispatch();
+}
+
+void InputThread::push_pointer_frame(Window& window, std::span<const PointerEvent> events, std::span<const PointerMotionEvent> motion_history) noexcept {
+    const auto now = std::chrono::steady_clock::now();
+    const auto num_events = motion_history.size() + events.size();
+    push_frame(num_events, [&](size_t i) -> QueuedEvent {
+        if (i < motion_history.size()) {
+            return { &window, now, 0, false, motion_history[i] };
+        }
+        return { &window, now, 0, i + 1 == num_events, events[i - motion_history.size()] };
+    });
+}
+
+void InputThread::push_touch_frame(Window& window, int id, std::span<const TouchEvent> events) noexcept {
+    const auto now = std::chrono::steady_clock::now();
+    push_frame(events.size(), [&](size_t i) -> QueuedEvent {
+        return { &window, now, id, i + 1 == events.size(), events[i] };
+    });
+}
+
+void InputThread::push_keysym(Window& window, const KeysymEvent& event) noexcept {
+    push_frame(1, [&](size_t) -> QueuedEvent {
+        return { &window, std::chrono::steady_clock::now(), 0, true, event };
+    });
+}
+
+void InputThread::push_text(Window& window, const TextEvent& event) noexcept {
+    push_frame(1, [&](size_t) -> QueuedEvent {
+        return { &window, std::chrono::steady_clock::now(), 0, true, event };
+    });
+}
+
+template<typename F>
+void InputThread::push_frame(size_t count, F&& make_event) noexcept {
+    // A partial frame would be merged into the next one, so frames are only ever dropped whole
+    if (_events.try_push_all(count, make_event)) {
+        _pushed = true;
+    } else {
+        _num_dropped.fetch_add(count, std::memory_order_relaxed);
+    }
+}
+
+void InputThread::deliver() {
+    QueuedEvent queued;
+    while (_events.try_pop(queued)) {
+        const std::chrono::duration<double, std::milli> latency = std::chrono::steady_clock::now() - queued.time;
+        ++_statistics.num_events;
+        _statistics.average_ms += latency.count();
+        _statistics.max_ms = std::max(_statistics.max_ms, latency.count());
+
+        if (const auto pointer_event = std::get_if<PointerEvent>(&queued.event)) {
+            _pointer_events.push_back(*pointer_event);
+            if (queued.end_of_frame) {
+                queued.window->pointer_events(_pointer_events, _motion_history);
+                _pointer_events.clear();
+                _motion_history.clear();
+            }
+        } else if (const auto sample = std::get_if<PointerMotionEvent>(&queued.event)) {
+            _motion_history.push_back(*sample);
+        } else if (const auto touch_event = std::get_if<TouchEvent>(&queued.event)) {
+            _touch_events.push_back(*touch_event);
+            if (queued.end_of_frame) {
+                queued.window->touch_events(queued.touch_id, _touch_events);
+                _touch_events.clear();
+            }
+        } else if (const auto keysym_event = std::get_if<KeysymEvent>(&queued.event)) {
+            queued.window->keysym_event(keysym_event->keysym, keysym_event->shift, keysym_event->ctrl, keysym_event->alt);
+        } else if (const auto text_event = std::get_if<TextEvent>(&queued.event)) {
+            queued.window->text_event(std::string_view(text_event->text.data(), text_event->length));
+        }
+    }
+}
+
+InputStatistics InputThread::statistics() const noexcept {
+    auto ret = _statistics;
+    ret.num_dropped = _num_dropped.load(std::memory_order_relaxed);
+    if (ret.num_events) {
+        ret.average_ms /= static_cast<double>(ret.num_events);
+    }
+    return ret;
+}
@@ -0,0 +1,93 @@
+#pragma once
+
+#include "EventThread.hpp"
+#include "InputEvent.hpp"
+
+#include "SpscQueue.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <span>
+#include <variant>
+#include <vector>
+
+class EventLoop;
+class Window;
+
+struct InputStatistics {
+    uint64_t num_events;
+    // Events lost because the window thread fell a whole queue behind. Pointer and touch frames are
+    // dropped whole, never split.
+    uint64_t num_dropped;
+    // Time from dispatch on the input thread to delivery to the window
+    double average_ms, max_ms;
+};
+
+// Dispatches the seats' event queue on its own event thread. Input listeners push their events
+// into a lock-free ring instead of calling into the window, and the thread that owns the window
+// delivers them from there, so a long frame never delays reading input and input never delays a frame.
+class InputThread {
+public:
+    explicit InputThread(wl_display *display);
+    InputThread(const InputThread&) = delete;
+    InputThread(InputThread&&) noexcept = delete;
+    ~InputThread();
+
+    InputThread& operator=(const InputThread&) = delete;
+    InputThread& operator=(InputThread&&) noexcept = delete;
+
+    // Seats must be moved to this queue, input objects created from them inherit it
+    wl_event_queue *queue() noexcept;
+
+    // Starts dispatching, waking the loop whenever events are pushed
+    void start(EventLoop& loop);
+    void stop() noexcept;
+    // Held while listeners run, so seats can be destroyed from other threads
+    std::unique_lock<std::mutex> lock_dispatch();
+
+    // Listeners only, each pointer or touch point frame is delivered as one span
+    void push_pointer_frame(Window& window, std::span<const PointerEvent> events, std::span<const PointerMotionEvent> motion_history) noexcept;
+    void push_touch_frame(Window& window, int id, std::span<const TouchEvent> events) noexcept;
+    void push_keysym(Window& window, const KeysymEvent& event) noexcept;
+    void push_text(Window& window, const TextEvent& event) noexcept;
+
+    // Window thread only, delivers every event pushed so far
+    void deliver();
+
+    InputStatistics statistics() const noexcept;
+
+private:
+    struct QueuedEvent {
+        Window *window;
+        std::chrono::steady_clock::time_point time;
+        int touch_id;
+        // Last event of a pointer or touch point frame
+        bool end_of_frame;
+        // A bare PointerMotionEvent is a sample of the motion history of the pointer frame that follows it
+        std::variant<PointerEvent, PointerMotionEvent, TouchEvent, KeysymEvent, TextEvent> event;
+    };
+
+    // A second of a 1000 Hz mouse, far longer than any frame should take
+    static constexpr size_t QUEUE_CAPACITY = 1024;
+
+    // Pushes make_event(0) to make_event(count - 1) as one frame, or drops all of them
+    template<typename F>
+    void push_frame(size_t count, F&& make_event) noexcept;
+
+private:
+    EventThread _thread;
+
+    SpscQueue<QueuedEvent, QUEUE_CAPACITY> _events;
+    std::atomic<uint64_t> _num_dropped;
+    // Input thread only, set when events were pushed since the loop was last woken
+    bool _pushed;
+
+    // Window thread only, reused for every frame
+    std::vector<PointerEvent> _pointer_events;
+    std::vector<PointerMotionEvent> _motion_history;
+    std::vector<TouchEvent> _touch_events;
+    // Sums over every delivered event
+    InputStatistics _statistics;
+};
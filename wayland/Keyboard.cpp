@@ -7,6 +7,8 @@
 
 #include <xkbcommon/xkbcommon-keysyms.h>
 
+#include <algorithm>
+
 static constexpr uint32_t XKB_EVDEV_OFFSET = 8;
 
 Keyboard::Keyboard(Seat& seat)
@@ -59,16 +61,17 @@ Keyboard::Keyboard(Seat& seat)
                     const auto ctrl = xkb_state_mod_name_is_active(self._state.get(), XKB_MOD_NAME_CTRL, XKB_STATE_MODS_EFFECTIVE);
                     const auto alt = xkb_state_mod_name_is_active(self._state.get(), XKB_MOD_NAME_ALT, XKB_STATE_MODS_EFFECTIVE);
 
+                    auto& input_thread = *self._display._input_thread;
                     for (auto i = 0; i < num_syms; ++i) {
-                        self._focus->keysym_event(syms[i], shift, ctrl, alt);
+                        input_thread.push_keysym(*self._focus, KeysymEvent{ syms[i], shift > 0, ctrl > 0, alt > 0 });
                     }
 
-                    const size_t chars = static_cast<size_t>(1 + xkb_state_key_get_utf8(self._state.get(), xkb_key, nullptr, 0));
-                    if (chars > 0) {
-                        const auto buf = std::make_unique_for_overwrite<char[]>(chars);
-                        xkb_state_key_get_utf8(self._state.get(), xkb_key, buf.get(), chars);
-
-                        self._focus->text_event(std::string_view(buf.get(), chars));
+                    // Truncated, and still null terminated, if it does not fit
+                    TextEvent text;
+                    const auto length = xkb_state_key_get_utf8(self._state.get(), xkb_key, text.text.data(), text.text.size());
+                    if (length > 0) {
+                        text.length = std::min(static_cast<uint32_t>(length), static_cast<uint32_t>(text.text.size() - 1));
+                        input_thread.push_text(*self._focus, text);
                     }
                     break;
                 }
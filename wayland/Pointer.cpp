@@ -4,137 +4,42 @@
 #include "Seat.hpp"
 #include "Window.hpp"
 
-#include <sstream>
+#include "Environment.hpp"
 
 static constexpr uint32_t LINUX_MOUSE_INPUT_CODE_OFFSET = 0x110;
 
-class EnterPointerEvent final : public EventBase {
-public:
-    EnterPointerEvent(uint32_t serial, int x, int y)
-        :_serial(serial)
-        ,_pos(x, y)
-    {}
-    EnterPointerEvent(const EnterPointerEvent&) = default;
-    EnterPointerEvent(EnterPointerEvent&&) noexcept = default;
-    ~EnterPointerEvent() final = default;
-
-    EnterPointerEvent& operator=(const EnterPointerEvent&) = default;
-    EnterPointerEvent& operator=(EnterPointerEvent&&) = default;
-
-    std::string to_string() const final {
-        std::stringstream ss;
-        ss << "Enter (serial: " << _serial << ", pos: (" << _pos.first << ", " << _pos.second  << "))"; 
-        return ss.str();
-    }
-
-private:
-    uint32_t _serial;
-    std::pair<int, int> _pos;
-};
-
-class LeavePointerEvent final : public EventBase {
-public:
-    LeavePointerEvent(uint32_t serial)
-        :_serial(serial)
-    {}
-    LeavePointerEvent(const LeavePointerEvent&) = default;
-    LeavePointerEvent(LeavePointerEvent&&) noexcept = default;
-    ~LeavePointerEvent() final = default;
-
-    LeavePointerEvent& operator=(const LeavePointerEvent&) = default;
-    LeavePointerEvent& operator=(LeavePointerEvent&&) = default;
-
-    std::string to_string() const final {
-        std::stringstream ss;
-        ss << "Leave (serial: " << _serial  << ")"; 
-        return ss.str();
-    }
-
-private:
-    uint32_t _serial;
-};
-
-class MotionPointerEvent final : public EventBase {
-public:
-    MotionPointerEvent(uint32_t serial, int x, int y)
-        :_serial(serial)
-        ,_pos(x, y)
-    {}
-    MotionPointerEvent(const MotionPointerEvent&) = default;
-    MotionPointerEvent(MotionPointerEvent&&) noexcept = default;
-    ~MotionPointerEvent() final = default;
-
-    MotionPointerEvent& operator=(const MotionPointerEvent&) = default;
-    MotionPointerEvent& operator=(MotionPointerEvent&&) = default;
-
-    std::string to_string() const final {
-        std::stringstream ss;
-        ss << "Motion (serial: " << _serial << ", pos: (" << _pos.first << ", " << _pos.second  << "))"; 
-        return ss.str();
-    }
-
-private:
-    uint32_t _serial;
-    std::pair<int, int> _pos;
-};
-
-class ButtonPointerEvent final : public EventBase {
-public:
-    ButtonPointerEvent(uint32_t serial, uint32_t time, uint32_t button, bool pressed)
-        :_serial(serial)
-        ,_time(time)
-        ,_button(button)
-        ,_pressed(pressed)
-    {}
-    ButtonPointerEvent(const ButtonPointerEvent&) = default;
-    ButtonPointerEvent(ButtonPointerEvent&&) noexcept = default;
-    ~ButtonPointerEvent() final = default;
-
-    ButtonPointerEvent& operator=(const ButtonPointerEvent&) = default;
-    ButtonPointerEvent& operator=(ButtonPointerEvent&&) = default;
-
-    std::string to_string() const final {
-        std::stringstream ss;
-        ss << "Button (serial: " << _serial << ", time: " << _time << ", button: " << _button << ", pressed: " << _pressed << ")"; 
-        return ss.str();
-    }
-
-private:
-    uint32_t _serial;
-    uint32_t _time;
-    uint32_t _button;
-    bool _pressed;
-};
-
-class AxisPointerEvent final : public EventBase {
-public:
-    AxisPointerEvent(uint32_t time, int32_t value, bool horizontal)
-        :_time(time)
-        ,_value(value)
-        ,_horizontal(horizontal)
-    {}
-    AxisPointerEvent(const AxisPointerEvent&) = default;
-    AxisPointerEvent(AxisPointerEvent&&) noexcept = default;
-    ~AxisPointerEvent() final = default;
-
-    AxisPointerEvent& operator=(const AxisPointerEvent&) = default;
-    AxisPointerEvent& operator=(AxisPointerEvent&&) = default;
-
-    std::string to_string() const final {
-        std::stringstream ss;
-        ss << "Axis (time: " << ", value: " << _value << ", horizontal: " << _horizontal << ")"; 
-        return ss.str();
+// Replaces every run of consecutive motion events with its last event, appending the rest of the run to the history
+static void coalesce_motion(std::vector<PointerEvent>& events, std::vector<PointerMotionEvent>& motion_history) {
+    size_t num_kept = 0;
+    for (size_t begin = 0, end = 0; begin < events.size(); begin = end) {
+        end = begin + 1;
+        if (std::holds_alternative<PointerMotionEvent>(events[begin])) {
+            while (end < events.size() && std::holds_alternative<PointerMotionEvent>(events[end])) {
+                ++end;
+            }
+        }
+
+        if (end - begin == 1) {
+            events[num_kept++] = events[begin];
+            continue;
+        }
+
+        const auto first_coalesced = static_cast<uint32_t>(motion_history.size());
+        for (auto i = begin; i + 1 < end; ++i) {
+            motion_history.push_back(std::get<PointerMotionEvent>(events[i]));
+        }
+        auto coalesced = std::get<PointerMotionEvent>(events[end - 1]);
+        coalesced.first_coalesced = first_coalesced;
+        coalesced.num_coalesced = static_cast<uint32_t>(end - 1 - begin);
+        events[num_kept++] = coalesced;
     }
-
-private:
-    uint32_t _time;
-    int32_t _value;
-    bool _horizontal;
-};
+    events.erase(events.begin() + static_cast<ptrdiff_t>(num_kept), events.end());
+}
 
 Pointer::Pointer(Seat& seat)
     :_display(seat._display)
     ,_focus(nullptr)
+    ,_coalesce_motion(get_env_flag("WAYLAND_EXAMPLE_COALESCE_MOTION"))
 {
     static constexpr wl_pointer_listener pointer_listener {
         .enter = [](void *data, wl_pointer *, uint32_t serial, wl_surface *surface, wl_fixed_t x, wl_fixed_t y) noexcept {
@@ -143,36 +48,32 @@ Pointer::Pointer(Seat& seat)
             if (surface) {
                 self._focus = static_cast<Window *>(wl_surface_get_user_data(surface));
                 self._cursor->set_pointer(serial);
-                self._events.emplace_back(std::make_unique<EnterPointerEvent>(serial, wl_fixed_to_int(x), wl_fixed_to_int(y)));
+                self._events.emplace_back(PointerEnterEvent{ serial, wl_fixed_to_double(x), wl_fixed_to_double(y) });
             }
         },
         .leave = [](void *data, wl_pointer *, uint32_t serial, wl_surface *) noexcept {
             auto& self = *static_cast<Pointer *>(data);
 
-            self._events.emplace_back(std::make_unique<LeavePointerEvent>(serial));
-
-            if (self._focus && !self._events.empty()) {
-                self._focus->pointer_events(self._events);
-            }
+            self._events.emplace_back(PointerLeaveEvent{ serial });
+            self.send_events();
 
-            self._events.clear();
             self._cursor->unset_pointer(serial);
             self._focus = nullptr;
         },
-        .motion  = [](void *data, wl_pointer *, uint32_t serial, wl_fixed_t x, wl_fixed_t y) noexcept {
+        .motion  = [](void *data, wl_pointer *, uint32_t time, wl_fixed_t x, wl_fixed_t y) noexcept {
             auto& self = *static_cast<Pointer *>(data);
 
-            self._events.emplace_back(std::make_unique<MotionPointerEvent>(serial, wl_fixed_to_int(x), wl_fixed_to_int(y)));
+            self._events.emplace_back(PointerMotionEvent{ time, wl_fixed_to_double(x), wl_fixed_to_double(y), 0, 0 });
         },
         .button = [](void *data, wl_pointer *, uint32_t serial, uint32_t time, uint32_t button, uint32_t state) noexcept {
             auto& self = *static_cast<Pointer *>(data);
 
             switch (state) {
             case WL_POINTER_BUTTON_STATE_RELEASED:
-                self._events.emplace_back(std::make_unique<ButtonPointerEvent>(serial, time, button - LINUX_MOUSE_INPUT_CODE_OFFSET, false));
+                self._events.emplace_back(PointerButtonEvent{ serial, time, button - LINUX_MOUSE_INPUT_CODE_OFFSET, false });
                 break;
             case WL_POINTER_BUTTON_STATE_PRESSED:
-                self._events.emplace_back(std::make_unique<ButtonPointerEvent>(serial, time, button - LINUX_MOUSE_INPUT_CODE_OFFSET, true));
+                self._events.emplace_back(PointerButtonEvent{ serial, time, button - LINUX_MOUSE_INPUT_CODE_OFFSET, true });
                 break;
             default:
                 break;
@@ -183,10 +84,10 @@ Pointer::Pointer(Seat& seat)
 
             switch (axis) {
             case WL_POINTER_AXIS_VERTICAL_SCROLL:
-                self._events.emplace_back(std::make_unique<AxisPointerEvent>(time, wl_fixed_to_int(value), false));
+                self._events.emplace_back(PointerAxisEvent{ time, wl_fixed_to_double(value), false });
                 break;
             case WL_POINTER_AXIS_HORIZONTAL_SCROLL:
-                self._events.emplace_back(std::make_unique<AxisPointerEvent>(time, wl_fixed_to_int(value), true));
+                self._events.emplace_back(PointerAxisEvent{ time, wl_fixed_to_double(value), true });
                 break;
             default:
                 break;
@@ -195,10 +96,7 @@ Pointer::Pointer(Seat& seat)
         .frame = [](void *data, wl_pointer *) noexcept {
             auto& self = *static_cast<Pointer *>(data);
 
-            if (self._focus && !self._events.empty()) {
-                self._focus->pointer_events(self._events);
-            }
-            self._events.clear();
+            self.send_events();
         },
         // The version of wl_seat (7) used will return these 3 events
         // Handling them is left as an exercise for the reader, but note that
@@ -210,8 +108,66 @@ Pointer::Pointer(Seat& seat)
         .axis_relative_direction = [](void *, wl_pointer *, uint32_t, uint32_t) noexcept {},
     };
 
+    static constexpr zwp_relative_pointer_v1_listener relative_pointer_listener {
+        // Part of the wl_pointer frame, so delivered alongside the absolute motion
+        .relative_motion = [](void *data, zwp_relative_pointer_v1 *, uint32_t utime_hi, uint32_t utime_lo, wl_fixed_t dx, wl_fixed_t dy, wl_fixed_t dx_unaccel, wl_fixed_t dy_unaccel) noexcept {
+            auto& self = *static_cast<Pointer *>(data);
+
+            self._events.emplace_back(PointerRelativeMotionEvent{
+                .utime = static_cast<uint64_t>(utime_hi) << 32 | utime_lo,
+                .dx = wl_fixed_to_double(dx),
+                .dy = wl_fixed_to_double(dy),
+                .dx_unaccelerated = wl_fixed_to_double(dx_unaccel),
+                .dy_unaccelerated = wl_fixed_to_double(dy_unaccel)
+            });
+        }
+    };
+
     _pointer.reset(wl_seat_get_pointer(seat._seat.get()));
     wl_pointer_add_listener(_pointer.get(), &pointer_listener, this);
 
     _cursor = _display._cursor_manager->get_cursor(_pointer.get());
+
+    if (_display._relative_pointer_manager) {
+        _relative_pointer.reset(zwp_relative_pointer_manager_v1_get_relative_pointer(_display._relative_pointer_manager.get(), _pointer.get()));
+        zwp_relative_pointer_v1_add_listener(_relative_pointer.get(), &relative_pointer_listener, this);
+    }
+
+    // A pointer plugged in after the window constrained the others joins them
+    if (_display._constrained_surface) {
+        constrain(_display._constrained_surface, _display._pointer_constraint);
+    }
+}
+
+void Pointer::constrain(wl_surface *surface, PointerConstraint constraint) {
+    // Only one constraint may exist per surface and pointer
+    _locked_pointer.reset();
+    _confined_pointer.reset();
+
+    const auto constraints = _display._pointer_constraints.get();
+    if (!constraints) {
+        return;
+    }
+
+    switch (constraint) {
+    case PointerConstraint::None:
+        break;
+    case PointerConstraint::Locked:
+        _locked_pointer.reset(zwp_pointer_constraints_v1_lock_pointer(constraints, surface, _pointer.get(), nullptr, ZWP_POINTER_CONSTRAINTS_V1_LIFETIME_PERSISTENT));
+        break;
+    case PointerConstraint::Confined:
+        _confined_pointer.reset(zwp_pointer_constraints_v1_confine_pointer(constraints, surface, _pointer.get(), nullptr, ZWP_POINTER_CONSTRAINTS_V1_LIFETIME_PERSISTENT));
+        break;
+    }
+}
+
+void Pointer::send_events() noexcept {
+    if (_focus && !_events.empty()) {
+        if (_coalesce_motion) {
+            coalesce_motion(_events, _motion_history);
+        }
+        _display._input_thread->push_pointer_frame(*_focus, _events, _motion_history);
+    }
+    _events.clear();
+    _motion_history.clear();
 }
@@ -1,15 +1,21 @@
 #pragma once
 
+#include "InputEvent.hpp"
 #include "WaylandPointer.hpp"
 
 #include <vector>
 
 class CursorBase;
 class Display;
-class EventBase;
 class Seat;
 class Window;
 
+enum class PointerConstraint {
+    None,
+    Locked,  // The pointer stops moving, only relative motion is reported
+    Confined // The pointer moves but cannot leave the surface
+};
+
 class Pointer {
 public:
     explicit Pointer(Seat& seat);
@@ -20,11 +26,29 @@ public:
     Pointer& operator=(const Pointer&) = delete;
     Pointer& operator=(Pointer&&) noexcept = delete;
 
+    // Replaces any constraint on the surface, does nothing without zwp_pointer_constraints_v1.
+    // Constraints persist, they are reactivated whenever the pointer enters the surface again.
+    void constrain(wl_surface *surface, PointerConstraint constraint);
+
+private:
+    // Hands the frame to the input thread and clears it
+    void send_events() noexcept;
+
 private:
     Display& _display;
     Window *_focus;
 
     WaylandPointer<wl_pointer> _pointer;
     std::unique_ptr<CursorBase> _cursor;
-    std::vector<std::unique_ptr<EventBase>> _events;
+    // Optional protocols
+    WaylandPointer<zwp_relative_pointer_v1> _relative_pointer;
+    WaylandPointer<zwp_locked_pointer_v1> _locked_pointer;
+    WaylandPointer<zwp_confined_pointer_v1> _confined_pointer;
+
+    // Events of the current frame, cleared but never shrunk once delivered
+    std::vector<PointerEvent> _events;
+
+    bool _coalesce_motion;
+    // Motion samples replaced by coalesced events of the current frame
+    std::vector<PointerMotionEvent> _motion_history;
 };
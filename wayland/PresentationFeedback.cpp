@@ -0,0 +1,159 @@
+#include "PresentationFeedback.hpp"
+
+#include <algorithm>
+#include <limits>
+#include <utility>
+
+static uint64_t now_ns(clockid_t clock_id) noexcept {
+    timespec ts;
+    clock_gettime(clock_id, &ts);
+    return static_cast<uint64_t>(ts.tv_sec) * 1'000'000'000 + static_cast<uint64_t>(ts.tv_nsec);
+}
+
+PresentationFeedback::PresentationFeedback(wp_presentation *presentation, clockid_t clock_id, wl_surface *surface)
+    :_presentation(presentation)
+    ,_clock_id(clock_id)
+    ,_surface(surface)
+    ,_pending{}
+    ,_last_request(nullptr)
+    ,_frames{}
+    ,_num_frames(0)
+    ,_num_discarded(0)
+    ,_missed_vblanks(0)
+{
+    for (auto& pending : _pending) {
+        pending.owner = this;
+    }
+}
+
+void PresentationFeedback::request() {
+    static constexpr wp_presentation_feedback_listener feedback_listener {
+        .sync_output = [](void *, wp_presentation_feedback *, wl_output *) noexcept {
+
+        },
+        .presented = [](void *data, wp_presentation_feedback *, uint32_t tv_sec_hi, uint32_t tv_sec_lo, uint32_t tv_nsec, uint32_t refresh, uint32_t seq_hi, uint32_t seq_lo, uint32_t flags) noexcept {
+            auto& pending = *static_cast<PendingFeedback *>(data);
+
+            const uint64_t tv_sec = (static_cast<uint64_t>(tv_sec_hi) << 32) | tv_sec_lo;
+            pending.owner->presented({
+                .committed_ns = pending.committed_ns,
+                .presented_ns = tv_sec * 1'000'000'000 + tv_nsec,
+                .refresh_ns = refresh,
+                .sequence = (static_cast<uint64_t>(seq_hi) << 32) | seq_lo,
+                .flags = flags
+            }, pending.target_ns);
+            pending.feedback.reset();
+        },
+        .discarded = [](void *data, wp_presentation_feedback *) noexcept {
+            auto& pending = *static_cast<PendingFeedback *>(data);
+
+            ++pending.owner->_num_discarded;
+            pending.feedback.reset();
+        }
+    };
+
+    // A commit can only be shown on the vblank after those of the frames still queued ahead of it
+    const auto committed_ns = now_ns(_clock_id);
+    auto target_ns = predicted_present_ns(committed_ns).value_or(0);
+    if (target_ns) {
+        for (const auto& pending : _pending) {
+            if (pending.feedback && pending.target_ns) {
+                target_ns = std::max(target_ns, pending.target_ns + *refresh_interval_ns());
+            }
+        }
+    }
+
+    for (auto& pending : _pending) {
+        if (!pending.feedback) {
+            pending.feedback.reset(wp_presentation_feedback(_presentation, _surface));
+            wp_presentation_feedback_add_listener(pending.feedback.get(), &feedback_listener, &pending);
+            pending.committed_ns = committed_ns;
+            pending.target_ns = target_ns;
+            _last_request = &pending;
+            return;
+        }
+    }
+    // Every slot is waiting on the compositor, skip feedback for this frame
+    _last_request = nullptr;
+}
+
+void PresentationFeedback::cancel() noexcept {
+    if (_last_request) {
+        std::exchange(_last_request, nullptr)->feedback.reset();
+    }
+}
+
+clockid_t PresentationFeedback::clock_id() const noexcept {
+    return _clock_id;
+}
+
+size_t PresentationFeedback::num_frames() const noexcept {
+    return std::min(_num_frames, _frames.size());
+}
+
+const PresentationTiming& PresentationFeedback::frame(size_t index) const noexcept {
+    return _frames[(_num_frames - num_frames() + index) % _frames.size()];
+}
+
+uint32_t PresentationFeedback::num_discarded() const noexcept {
+    return _num_discarded;
+}
+
+uint32_t PresentationFeedback::missed_vblanks() const noexcept {
+    return _missed_vblanks;
+}
+
+std::optional<uint32_t> PresentationFeedback::refresh_interval_ns() const noexcept {
+    if (!_num_frames || !frame(num_frames() - 1).refresh_ns) {
+        return std::nullopt;
+    }
+    return frame(num_frames() - 1).refresh_ns;
+}
+
+LatencyStatistics PresentationFeedback::latency_statistics() const noexcept {
+    if (!num_frames()) {
+        return {};
+    }
+
+    LatencyStatistics ret {
+        .num_frames = static_cast<uint32_t>(num_frames()),
+        .min_ms = std::numeric_limits<double>::max(),
+        .average_ms = 0.0,
+        .max_ms = 0.0
+    };
+    for (size_t i = 0; i < num_frames(); ++i) {
+        const auto& timing = frame(i);
+        // Both times are in the presentation clock, so no sampling delay is added on either end
+        const auto latency_ms = static_cast<double>(static_cast<int64_t>(timing.presented_ns - timing.committed_ns)) / 1e6;
+        ret.min_ms = std::min(ret.min_ms, latency_ms);
+        ret.max_ms = std::max(ret.max_ms, latency_ms);
+        ret.average_ms += latency_ms;
+    }
+    ret.average_ms /= ret.num_frames;
+    return ret;
+}
+
+std::optional<uint64_t> PresentationFeedback::predicted_present_ns(uint64_t now_ns) const noexcept {
+    const auto refresh_ns = refresh_interval_ns();
+    if (!refresh_ns) {
+        return std::nullopt;
+    }
+
+    const auto last_present_ns = frame(num_frames() - 1).presented_ns;
+    if (now_ns < last_present_ns) {
+        return last_present_ns + *refresh_ns;
+    }
+    const auto cycles = (now_ns - last_present_ns) / *refresh_ns + 1;
+    return last_present_ns + cycles * *refresh_ns;
+}
+
+void PresentationFeedback::presented(const PresentationTiming& timing, uint64_t target_ns) noexcept {
+    // Half a cycle of slack absorbs jitter between the prediction and the reported time
+    if ((timing.flags & WP_PRESENTATION_FEEDBACK_KIND_VSYNC) && timing.refresh_ns && target_ns
+        && timing.presented_ns > target_ns + timing.refresh_ns / 2)
+    {
+        _missed_vblanks += static_cast<uint32_t>((timing.presented_ns - target_ns + timing.refresh_ns / 2) / timing.refresh_ns);
+    }
+
+    _frames[_num_frames++ % _frames.size()] = timing;
+}
@@ -0,0 +1,85 @@
+#pragma once
+
+#include "WaylandPointer.hpp"
+
+#include <array>
+#include <optional>
+
+#include <time.h>
+
+inline constexpr size_t PRESENTATION_HISTORY = 128;
+
+struct LatencyStatistics {
+    uint32_t num_frames;
+    double min_ms, average_ms, max_ms;
+};
+
+struct PresentationTiming {
+    // Time feedback was requested, right after the frame was submitted, in the presentation clock
+    uint64_t committed_ns;
+    // Time the frame was shown, in the compositor's presentation clock
+    uint64_t presented_ns;
+    // Duration of a refresh cycle, 0 if unknown or variable
+    uint32_t refresh_ns;
+    // Vblank counter of the output, only meaningful with the vsync flag
+    uint64_t sequence;
+    // Bitmask of wp_presentation_feedback_kind
+    uint32_t flags;
+};
+
+// Collects wp_presentation feedback for every committed frame of a surface
+class PresentationFeedback {
+public:
+    PresentationFeedback(wp_presentation *presentation, clockid_t clock_id, wl_surface *surface);
+    PresentationFeedback(const PresentationFeedback&) = delete;
+    PresentationFeedback(PresentationFeedback&&) noexcept = delete;
+    ~PresentationFeedback() = default;
+
+    PresentationFeedback& operator=(const PresentationFeedback&) = delete;
+    PresentationFeedback& operator=(PresentationFeedback&&) noexcept = delete;
+
+    // Requests feedback for the next commit of the surface
+    void request();
+    // Drops the request made for a commit that never happened
+    void cancel() noexcept;
+
+    clockid_t clock_id() const noexcept;
+    // Most recent presented frames, oldest first
+    size_t num_frames() const noexcept;
+    const PresentationTiming& frame(size_t index) const noexcept;
+    uint32_t num_discarded() const noexcept;
+
+    // Refresh cycles frames were shown after the vblank they were committed for. Vblanks that pass
+    // while nothing is committed, such as when redrawing on demand, are not misses.
+    uint32_t missed_vblanks() const noexcept;
+    std::optional<uint32_t> refresh_interval_ns() const noexcept;
+    // Time from submission to the compositor reporting the frame as shown, over the most recent frames
+    LatencyStatistics latency_statistics() const noexcept;
+    // Extrapolates the next vblank after now_ns from the last presented frame
+    std::optional<uint64_t> predicted_present_ns(uint64_t now_ns) const noexcept;
+
+private:
+    struct PendingFeedback {
+        PresentationFeedback *owner;
+        WaylandPointer<wp_presentation_feedback> feedback;
+        uint64_t committed_ns;
+        // Predicted vblank the commit was made for, 0 if there was no prediction
+        uint64_t target_ns;
+    };
+
+    void presented(const PresentationTiming& timing, uint64_t target_ns) noexcept;
+
+private:
+    wp_presentation *_presentation;
+    clockid_t _clock_id;
+    wl_surface *_surface;
+
+    // Feedback is only outstanding for the few frames queued in the compositor at once
+    std::array<PendingFeedback, 8> _pending;
+    PendingFeedback *_last_request;
+
+    std::array<PresentationTiming, PRESENTATION_HISTORY> _frames;
+    size_t _num_frames;
+    uint32_t _num_discarded;
+    uint32_t _missed_vblanks;
+};
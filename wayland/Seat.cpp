@@ -1,5 +1,6 @@
 #include "Seat.hpp"
 
+#include "Display.hpp"
 #include "cursor/CursorBase.hpp"
 
 Seat::Seat(Display& display, wl_seat *seat, uint32_t global_name)
@@ -39,8 +40,16 @@ Seat::Seat(Display& display, wl_seat *seat, uint32_t global_name)
     };
 
     wl_seat_add_listener(_seat.get(), &seat_listener, this);
+    // Pointers, keyboards and touch devices are created from the seat and so share its queue
+    wl_proxy_set_queue(reinterpret_cast<wl_proxy *>(_seat.get()), display._input_thread->queue());
 }
 
 uint32_t Seat::global_name() const noexcept {
     return _name;
 }
+
+void Seat::constrain_pointer(wl_surface *surface, PointerConstraint constraint) {
+    if (_pointer) {
+        _pointer->constrain(surface, constraint);
+    }
+}
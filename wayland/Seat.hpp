@@ -23,6 +23,9 @@ public:
 
     uint32_t global_name() const noexcept;
 
+    // Does nothing if the seat has no pointer
+    void constrain_pointer(wl_surface *surface, PointerConstraint constraint);
+
 private:
     Display& _display;
     WaylandPointer<wl_seat> _seat;
@@ -3,8 +3,7 @@
 #include "TouchPoint.hpp"
 #include "WaylandPointer.hpp"
 
-#include <unordered_map>
-
+#include <vector>
 
 class Display;
 class Seat;
@@ -19,9 +18,13 @@ public:
     Touch& operator=(const Touch&) = delete;
     Touch& operator=(Touch&&) noexcept = delete;
 
+private:
+    TouchPoint *find_touchpoint(int32_t id) noexcept;
+
 private:
     Display& _display;
 
     WaylandPointer<wl_touch> _touch;
-    std::unordered_map<int32_t, TouchPoint> _touchpoints;
+    // Few enough to search, lifted ones are reused by the next touch
+    std::vector<TouchPoint> _touchpoints;
 };
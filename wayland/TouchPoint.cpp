@@ -1,19 +1,38 @@
 #include "TouchPoint.hpp"
 
-#include "Window.hpp"
+#include "InputThread.hpp"
 
 TouchPoint::TouchPoint(int id, Window& focus)
     :_id(id)
     ,_focus(&focus)
 {}
 
-void TouchPoint::clear_events() {
+void TouchPoint::add_event(const TouchEvent& event) {
+    _events.push_back(event);
+}
+
+bool TouchPoint::active() const noexcept {
+    return _focus;
+}
+
+void TouchPoint::begin(int id, Window& focus) noexcept {
+    _id = id;
+    _focus = &focus;
+    clear_events();
+}
+
+void TouchPoint::clear_events() noexcept {
     _events.clear();
 }
 
-void TouchPoint::send_events() {
+void TouchPoint::end() noexcept {
+    _focus = nullptr;
+    clear_events();
+}
+
+void TouchPoint::send_events(InputThread& input_thread) noexcept {
     if (_focus && !_events.empty()) {
-        _focus->touch_events(_id, _events);
+        input_thread.push_touch_frame(*_focus, _id, _events);
     }
 
     clear_events();
@@ -1,28 +1,31 @@
 #pragma once
 
-#include "EventBase.hpp"
+#include "InputEvent.hpp"
 
-#include <memory>
 #include <vector>
 
+class InputThread;
 class Window;
 
+// Touch points are kept and reused once lifted, so that their event buffers only grow while a
+// touch is held for the first time
 class TouchPoint {
     friend class Touch;
 public:
     TouchPoint(int id, Window& focus);
 
-    template<typename T, typename... Args>
-    void add_event(Args... args) {
-        _events.emplace_back(std::make_unique<T>(std::forward<Args>(args)...));
-    }
+    void add_event(const TouchEvent& event);
 
 private:
-    void clear_events();
-    void send_events();
+    bool active() const noexcept;
+    void begin(int id, Window& focus) noexcept;
+    void clear_events() noexcept;
+    void end() noexcept;
+    void send_events(InputThread& input_thread) noexcept;
 
 private:
     int _id;
+    // Null once the touch point has been lifted or cancelled
     Window * _focus;
-    std::vector<std::unique_ptr<EventBase>> _events;
+    std::vector<TouchEvent> _events;
 };
@@ -3,6 +3,9 @@
 #include "wayland-content-type-client-protocol.h"
 #include "wayland-cursor-shape-client-protocol.h"
 #include "wayland-fractional-scale-client-protocol.h"
+#include "wayland-pointer-constraints-client-protocol.h"
+#include "wayland-presentation-time-client-protocol.h"
+#include "wayland-relative-pointer-client-protocol.h"
 #include "wayland-viewporter-client-protocol.h"
 #include "wayland-xdg-decoration-client-protocol.h"
 #include "wayland-xdg-shell-client-protocol.h"
@@ -16,6 +19,10 @@ struct WaylandDeleter {
         wl_buffer_destroy(wl_buffer);
     }
 
+    void operator()(wl_callback *wl_callback) const noexcept {
+        wl_callback_destroy(wl_callback);
+    }
+
     void operator()(wl_compositor *wl_compositor) const noexcept {
         wl_compositor_destroy(wl_compositor);
     }
@@ -28,6 +35,10 @@ struct WaylandDeleter {
         wl_display_disconnect(display);
     }
 
+    void operator()(wl_event_queue *wl_event_queue) const noexcept {
+        wl_event_queue_destroy(wl_event_queue);
+    }
+
     void operator()(wl_keyboard *wl_keyboard) const noexcept {
         wl_keyboard_release(wl_keyboard);
     }
@@ -82,6 +93,14 @@ struct WaylandDeleter {
     }
 
 
+    void operator()(wp_presentation *wp_presentation) const noexcept {
+        wp_presentation_destroy(wp_presentation);
+    }
+
+    void operator()(wp_presentation_feedback *wp_presentation_feedback) const noexcept {
+        wp_presentation_feedback_destroy(wp_presentation_feedback);
+    }
+
     void operator()(wp_viewport *wp_viewport) const noexcept {
         wp_viewport_destroy(wp_viewport);
     }
@@ -113,6 +132,26 @@ struct WaylandDeleter {
     void operator()(zxdg_toplevel_decoration_v1 *zxdg_toplevel_decoration_v1) const noexcept {
         zxdg_toplevel_decoration_v1_destroy(zxdg_toplevel_decoration_v1);
     }
+
+    void operator()(zwp_confined_pointer_v1 *zwp_confined_pointer_v1) const noexcept {
+        zwp_confined_pointer_v1_destroy(zwp_confined_pointer_v1);
+    }
+
+    void operator()(zwp_locked_pointer_v1 *zwp_locked_pointer_v1) const noexcept {
+        zwp_locked_pointer_v1_destroy(zwp_locked_pointer_v1);
+    }
+
+    void operator()(zwp_pointer_constraints_v1 *zwp_pointer_constraints_v1) const noexcept {
+        zwp_pointer_constraints_v1_destroy(zwp_pointer_constraints_v1);
+    }
+
+    void operator()(zwp_relative_pointer_v1 *zwp_relative_pointer_v1) const noexcept {
+        zwp_relative_pointer_v1_destroy(zwp_relative_pointer_v1);
+    }
+
+    void operator()(zwp_relative_pointer_manager_v1 *zwp_relative_pointer_manager_v1) const noexcept {
+        zwp_relative_pointer_manager_v1_destroy(zwp_relative_pointer_manager_v1);
+    }
 };
 
 template<typename T>
@@ -2,6 +2,9 @@
 
 #include "Display.hpp"
 
+#include "Environment.hpp"
+
+#include <array>
 #include <cstring>
 #include <utility>
 #include <wayland-client-protocol.h>
@@ -9,9 +12,38 @@
 static constexpr int32_t DEFAULT_HEIGHT = 600;
 static constexpr int32_t DEFAULT_WIDTH = 800;
 static constexpr char WINDOW_TITLE[] = "Wayland Example";
+// Longer descriptions are truncated
+static constexpr size_t MAX_EVENT_STRING_LENGTH = 128;
+
+static PointerConstraint next_pointer_constraint(PointerConstraint constraint) noexcept {
+    switch (constraint) {
+    case PointerConstraint::None:
+        return PointerConstraint::Locked;
+    case PointerConstraint::Locked:
+        return PointerConstraint::Confined;
+    case PointerConstraint::Confined:
+    default:
+        return PointerConstraint::None;
+    }
+}
+
+static const char *to_string(PointerConstraint constraint) noexcept {
+    switch (constraint) {
+    case PointerConstraint::None:
+        return "none";
+    case PointerConstraint::Locked:
+        return "locked";
+    case PointerConstraint::Confined:
+        return "confined";
+    default:
+        return "unknown";
+    }
+}
 
 Window::Window(Display& display)
     :_display(display)
+    ,_pending{}
+    ,_configured(false)
 {
     static constexpr wl_surface_listener wl_surface_listener {
         .enter = [](void *, wl_surface *, wl_output *) noexcept {
@@ -22,8 +54,9 @@ Window::Window(Display& display)
         },
         .preferred_buffer_scale = [](void *data, wl_surface *, int32_t factor){
             auto& self = *static_cast<Window *>(data);
+            const auto lock = std::unique_lock{ self._mutex };
 
-            self._desired_integer_scale = factor;
+            self._pending.integer_scale = factor;
         },
         .preferred_buffer_transform = [](void *, wl_surface *, uint32_t) noexcept {
             
@@ -31,59 +64,37 @@ Window::Window(Display& display)
     };
 
     static constexpr xdg_surface_listener wm_surface_listener {
-        .configure = [](void *data, xdg_surface *surface, uint32_t serial) noexcept {
+        .configure = [](void *data, xdg_surface *, uint32_t serial) noexcept {
             auto& self = *static_cast<Window *>(data);
+            const auto lock = std::unique_lock{ self._mutex };
 
-            xdg_surface_ack_configure(surface, serial);
-
-            if (self._desired_surface_bounds.has_value()) {
-                self._actual_surface_bounds = self._desired_surface_bounds.value();
-            }
-            self._desired_surface_bounds = std::nullopt;
-
-            if (self._desired_surface_size.has_value()) {
-                self._actual_surface_size = self._desired_surface_size.value();
-            }
-            self._desired_surface_size = std::nullopt;
-
-            if (self._desired_fractional_scale.has_value()) {
-                self._actual_fractional_scale = self._desired_fractional_scale.value();
-            }
-            self._desired_fractional_scale = std::nullopt;
-
-            if (self._desired_integer_scale.has_value()) {
-                self._actual_integer_scale = self._desired_integer_scale.value();
-            }
-            self._desired_integer_scale = std::nullopt;
-
-            if (self._actual_fractional_scale) {
-                const auto size = self.surface_size();
-                wp_viewport_set_destination(self._viewport.get(), size.first, size.second);
-                wl_surface_set_buffer_scale(self._surface.get(), 1);
-            } else if (self._actual_integer_scale) {
-                wl_surface_set_buffer_scale(self._surface.get(), self._actual_integer_scale);
-            } else {
-                wl_surface_set_buffer_scale(self._surface.get(), 1);
-            }
+            self._pending.configure_serial = serial;
         }
     };
 
     static constexpr xdg_toplevel_listener toplevel_listener {
         .configure = [](void *data, xdg_toplevel *, int32_t width, int32_t height, wl_array *states) noexcept {
             auto& self = *static_cast<Window*>(data);
+            const auto lock = std::unique_lock{ self._mutex };
 
-            self._desired_surface_size = { width, height };
-            self._fullscreen = false;
-            self._maximized = false;
+            self._pending.surface_size = { width, height };
+            self._pending.fullscreen = false;
+            self._pending.maximized = false;
+            self._pending.suspended = false;
 
             for (const auto *pstate = (int32_t *)states->data; states->size != 0 && (const char *)pstate < ((const char *) states->data + states->size); pstate++) {
                 switch (*pstate) {
                 case XDG_TOPLEVEL_STATE_MAXIMIZED:
-                    self._maximized = true;
+                    self._pending.maximized = true;
                     break;
                 case XDG_TOPLEVEL_STATE_FULLSCREEN:
-                    self._fullscreen = true;
+                    self._pending.fullscreen = true;
                     break;
+#ifdef XDG_TOPLEVEL_STATE_SUSPENDED_SINCE_VERSION
+                case XDG_TOPLEVEL_STATE_SUSPENDED:
+                    self._pending.suspended = true;
+                    break;
+#endif
                 default:
                     break;
                 }
@@ -91,13 +102,15 @@ Window::Window(Display& display)
         },
         .close = [](void *data, xdg_toplevel *) noexcept {
             auto& self = *static_cast<Window*>(data);
+            const auto lock = std::unique_lock{ self._mutex };
 
-            self._closed = true;
+            self._pending.closed = true;
         },
         .configure_bounds = [](void *data, xdg_toplevel *, int32_t width, int32_t height) noexcept {
             auto& self = *static_cast<Window*>(data);
-                        
-            self._desired_surface_bounds = { width, height };
+            const auto lock = std::unique_lock{ self._mutex };
+
+            self._pending.surface_bounds = { width, height };
         },
         .wm_capabilities = [](void *, xdg_toplevel *, wl_array *) noexcept {
             
@@ -107,33 +120,27 @@ Window::Window(Display& display)
     static constexpr wp_fractional_scale_v1_listener fractional_scale_listener {
         .preferred_scale = [](void *data, wp_fractional_scale_v1 *, uint32_t scale) noexcept {
             auto& self = *static_cast<Window*>(data);
+            const auto lock = std::unique_lock{ self._mutex };
 
-            self._desired_fractional_scale = scale;
+            self._pending.fractional_scale = scale;
         }
     };
 
     static constexpr zxdg_toplevel_decoration_v1_listener toplevel_decoration_listener {
         .configure = [](void *data, zxdg_toplevel_decoration_v1 *, uint32_t mode) noexcept {
             auto& self = *static_cast<Window*>(data);
+            const auto lock = std::unique_lock{ self._mutex };
 
-            switch (mode) {
-            case ZXDG_TOPLEVEL_DECORATION_V1_MODE_CLIENT_SIDE:
-                self._has_server_decorations = false;
-                if (!self._fullscreen) {
-                    self.toggle_fullscreen();
-                }
-                break;
-            case ZXDG_TOPLEVEL_DECORATION_V1_MODE_SERVER_SIDE:
-                self._has_server_decorations = true;
-                break;
-            default:
-                break;
-            }
+            self._pending.decoration_mode = mode;
         }
     };
 
     _surface.reset(wl_compositor_create_surface(_display._compositor.get()));
     wl_surface_add_listener(_surface.get(), &wl_surface_listener, this);
+    _frame_scheduler.emplace(_surface.get());
+    if (_display._presentation) {
+        _presentation_feedback.emplace(_display._presentation.get(), _display._presentation_clock, _surface.get());
+    }
 
     _wm_surface.reset(xdg_wm_base_get_xdg_surface(_display._wm_base.get(), _surface.get()));
     xdg_surface_add_listener(_wm_surface.get(), &wm_surface_listener, this);
@@ -149,14 +156,18 @@ Window::Window(Display& display)
     }
 
     if (_display._has_fractional_scale) {
-        _fractional_scale.reset(wp_fractional_scale_manager_v1_get_fractional_scale(display._fractional_scale_manager.get(), _surface.get()));
+        _fractional_scale.reset(_display.create_on_shell_queue(display._fractional_scale_manager.get(), [&](wp_fractional_scale_manager_v1 *manager) {
+            return wp_fractional_scale_manager_v1_get_fractional_scale(manager, _surface.get());
+        }));
         wp_fractional_scale_v1_add_listener(_fractional_scale.get(), &fractional_scale_listener, this);
 
         _viewport.reset(wp_viewporter_get_viewport(display._viewporter.get(), _surface.get()));
     }
 
     if (_display._decoration_manager) {
-        _toplevel_decoration.reset(zxdg_decoration_manager_v1_get_toplevel_decoration(display._decoration_manager.get(), _toplevel.get()));
+        _toplevel_decoration.reset(_display.create_on_shell_queue(display._decoration_manager.get(), [&](zxdg_decoration_manager_v1 *manager) {
+            return zxdg_decoration_manager_v1_get_toplevel_decoration(manager, _toplevel.get());
+        }));
         zxdg_toplevel_decoration_v1_add_listener(_toplevel_decoration.get(), &toplevel_decoration_listener, this);
         zxdg_toplevel_decoration_v1_set_mode(_toplevel_decoration.get(), ZXDG_TOPLEVEL_DECORATION_V1_MODE_SERVER_SIDE);
     }
@@ -165,6 +176,11 @@ Window::Window(Display& display)
     _fullscreen = false;
     _maximized = false;
     _has_server_decorations = !!_display._decoration_manager;
+    _redraw_requested = true;
+    _continuous_rendering = false;
+    _suspended = false;
+    _present_policy = parse_present_policy(get_env_string("WAYLAND_EXAMPLE_PRESENT_POLICY")).value_or(PresentPolicy::PowerSaving);
+    _pointer_constraint = PointerConstraint::None;
 
     _actual_integer_scale = 0;
 
@@ -185,6 +201,19 @@ Window::Window(Display& display)
     wl_display_roundtrip(_display._display.get());
 }
 
+Window::~Window() {
+    if (_pointer_constraint != PointerConstraint::None) {
+        _display.constrain_pointers(_surface.get(), PointerConstraint::None);
+    }
+
+    // Listeners of the shell objects may be running on the shell event thread
+    const auto lock = _display.lock_shell_dispatch();
+    _toplevel_decoration.reset();
+    _fractional_scale.reset();
+    _toplevel.reset();
+    _wm_surface.reset();
+}
+
 void Window::keysym_event(uint32_t keysym, bool, bool, bool alt) noexcept {
     switch (keysym) {
     case XKB_KEY_Return:
@@ -197,15 +226,39 @@ void Window::keysym_event(uint32_t keysym, bool, bool, bool alt) noexcept {
     case XKB_KEY_Escape:
         _closed = true;
         break;
+    case XKB_KEY_p:
+    case XKB_KEY_P:
+        _present_policy = next_present_policy(_present_policy);
+        _redraw_requested = true;
+        break;
+    case XKB_KEY_l:
+    case XKB_KEY_L:
+        if (_display._pointer_constraints) {
+            _pointer_constraint = next_pointer_constraint(_pointer_constraint);
+            _display.constrain_pointers(_surface.get(), _pointer_constraint);
+            printf("Pointer constraint: %s\n", to_string(_pointer_constraint));
+        }
+        break;
     default:
         break;
     }
 }
 
-void Window::pointer_events(const std::vector<std::unique_ptr<EventBase>>& events) const noexcept {
+void Window::pointer_events(std::span<const PointerEvent> events, std::span<const PointerMotionEvent> motion_history) const noexcept {
     puts("Pointer");
     for (const auto& event : events) {
-        printf("\t%s\n", event->to_string().c_str());
+        std::array<char, MAX_EVENT_STRING_LENGTH> str;
+        format_event(str, event);
+        printf("\t%s\n", str.data());
+
+        // Indices past the history delivered with the frame are skipped rather than read
+        const auto motion = std::get_if<PointerMotionEvent>(&event);
+        if (motion && motion->num_coalesced && motion->first_coalesced <= motion_history.size()
+            && motion->num_coalesced <= motion_history.size() - motion->first_coalesced) {
+            for (const auto& sample : motion_history.subspan(motion->first_coalesced, motion->num_coalesced)) {
+                printf("\t\tSample (time: %u, pos: (%.2f, %.2f))\n", sample.time, sample.x, sample.y);
+            }
+        }
     }
 }
 
@@ -213,10 +266,12 @@ void Window::text_event(std::string_view str) const noexcept {
     fwrite(str.data(), 1, str.size(), stdout);
 }
 
-void Window::touch_events(int id, const std::vector<std::unique_ptr<EventBase>>& events) const noexcept {
+void Window::touch_events(int id, std::span<const TouchEvent> events) const noexcept {
     printf("Touchpoint %d\n", id);
     for (const auto& event : events) {
-        printf("\t%s\n", event->to_string().c_str());
+        std::array<char, MAX_EVENT_STRING_LENGTH> str;
+        format_event(str, event);
+        printf("\t%s\n", str.data());
     }
 }
 
@@ -224,6 +279,44 @@ wl_display *Window::display() noexcept {
     return _display._display.get();
 }
 
+void Window::begin_frame() {
+    _frame_scheduler->arm();
+    if (_presentation_feedback) {
+        _presentation_feedback->request();
+    }
+    _redraw_requested = false;
+}
+
+void Window::cancel_frame() noexcept {
+    _frame_scheduler->cancel();
+    if (_presentation_feedback) {
+        _presentation_feedback->cancel();
+    }
+}
+
+bool Window::frame_due() const noexcept {
+    return _configured
+        && (_redraw_requested || _continuous_rendering)
+        && !_frame_scheduler->callback_pending()
+        && !_suspended;
+}
+
+const FrameScheduler& Window::frame_scheduler() const noexcept {
+    return *_frame_scheduler;
+}
+
+const std::optional<PresentationFeedback>& Window::presentation_feedback() const noexcept {
+    return _presentation_feedback;
+}
+
+void Window::request_frame() noexcept {
+    _redraw_requested = true;
+}
+
+PresentPolicy Window::present_policy() const noexcept {
+    return _present_policy;
+}
+
 uint32_t Window::buffer_scale() const noexcept {
     if (_actual_fractional_scale) return _actual_fractional_scale;
     if (_actual_integer_scale) return static_cast<uint32_t>(_actual_integer_scale) * DEFAULT_SCALE_DPI;
@@ -251,6 +344,10 @@ std::pair<uint32_t, uint32_t> Window::surface_size() const noexcept {
     return size;
 }
 
+void Window::set_continuous_rendering(bool continuous) noexcept {
+    _continuous_rendering = continuous;
+}
+
 bool Window::should_close() const noexcept {
     return _closed;
 }
@@ -259,6 +356,82 @@ wl_surface *Window::surface() noexcept {
     return _surface.get();
 }
 
+void Window::update() {
+    PendingState pending;
+    {
+        const auto lock = std::unique_lock{ _mutex };
+        pending = _pending;
+
+        _pending.closed = false;
+        _pending.decoration_mode.reset();
+        // Everything else waits for the configure that applies it
+        if (_pending.configure_serial) {
+            _pending.configure_serial.reset();
+            _pending.integer_scale.reset();
+            _pending.fractional_scale.reset();
+            _pending.surface_bounds.reset();
+            _pending.surface_size.reset();
+        }
+    }
+
+    if (pending.closed) {
+        _closed = true;
+    }
+
+    if (pending.configure_serial) {
+        // Acked here rather than in the listener, so the next commit is the one that reflects it
+        xdg_surface_ack_configure(_wm_surface.get(), pending.configure_serial.value());
+
+        if (pending.surface_bounds.has_value()) {
+            _actual_surface_bounds = pending.surface_bounds.value();
+        }
+        if (pending.surface_size.has_value()) {
+            _actual_surface_size = pending.surface_size.value();
+        }
+        if (pending.fractional_scale.has_value()) {
+            _actual_fractional_scale = pending.fractional_scale.value();
+        }
+        if (pending.integer_scale.has_value()) {
+            _actual_integer_scale = pending.integer_scale.value();
+        }
+        _fullscreen = pending.fullscreen;
+        _maximized = pending.maximized;
+        _suspended = pending.suspended;
+
+        if (_actual_fractional_scale) {
+            const auto size = surface_size();
+            wp_viewport_set_destination(_viewport.get(), size.first, size.second);
+            wl_surface_set_buffer_scale(_surface.get(), 1);
+        } else if (_actual_integer_scale) {
+            wl_surface_set_buffer_scale(_surface.get(), _actual_integer_scale);
+        } else {
+            wl_surface_set_buffer_scale(_surface.get(), 1);
+        }
+
+        _configured = true;
+        _redraw_requested = true;
+    }
+
+    switch (pending.decoration_mode.value_or(0)) {
+    case ZXDG_TOPLEVEL_DECORATION_V1_MODE_CLIENT_SIDE:
+        _has_server_decorations = false;
+        if (!_fullscreen) {
+            toggle_fullscreen();
+        }
+        break;
+    case ZXDG_TOPLEVEL_DECORATION_V1_MODE_SERVER_SIDE:
+        _has_server_decorations = true;
+        break;
+    default:
+        break;
+    }
+
+    if (pending.configure_serial || pending.decoration_mode) {
+        // The loop may already have flushed for the last time before it sleeps
+        wl_display_flush(_display._display.get());
+    }
+}
+
 void Window::toggle_fullscreen() noexcept {
     if (!_fullscreen) {
         xdg_toplevel_set_fullscreen(_toplevel.get(), nullptr);
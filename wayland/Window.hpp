@@ -1,27 +1,33 @@
 #pragma once
 
+#include "FrameScheduler.hpp"
+#include "InputEvent.hpp"
+#include "PresentationFeedback.hpp"
 #include "WaylandPointer.hpp"
 
+#include "PresentPolicy.hpp"
+
+#include <mutex>
 #include <optional>
+#include <span>
 #include <vector>
 
 class Display;
-class EventBase;
 
 class Window {
 public:
     explicit Window(Display& display);
     Window(const Window&) = delete;
     Window(Window&&) noexcept = delete;
-    ~Window() = default;
+    ~Window();
 
     Window& operator=(const Window&) = delete;
     Window& operator=(Window&&) noexcept = delete;
 
     void keysym_event(uint32_t keysym, bool shift, bool ctrl, bool alt) noexcept;
-    void pointer_events(const std::vector<std::unique_ptr<EventBase>>& events) const noexcept;
+    void pointer_events(std::span<const PointerEvent> events, std::span<const PointerMotionEvent> motion_history) const noexcept;
     void text_event(std::string_view str) const noexcept;
-    void touch_events(int id, const std::vector<std::unique_ptr<EventBase>>& events) const noexcept;
+    void touch_events(int id, std::span<const TouchEvent> events) const noexcept;
 
     // Numerator of a fraction with DEFAULT_SCALE_DPI as the denominator
     uint32_t buffer_scale() const noexcept;
@@ -30,14 +36,45 @@ public:
 
     wl_display *display() noexcept;
 
+    PresentPolicy present_policy() const noexcept;
+
+    // Called by the renderer right before it presents, and so commits, a new buffer
+    void begin_frame();
+    // Called by the renderer if the buffer from begin_frame() was never committed
+    void cancel_frame() noexcept;
+    // True when the contents need redrawing and the compositor is ready for them
+    bool frame_due() const noexcept;
+    const FrameScheduler& frame_scheduler() const noexcept;
+    // Empty if the compositor lacks wp_presentation
+    const std::optional<PresentationFeedback>& presentation_feedback() const noexcept;
+    void request_frame() noexcept;
+    // Redraw on every frame callback, rather than only when the contents change
+    void set_continuous_rendering(bool continuous) noexcept;
+
     bool should_close() const noexcept;
 
+    // Applies what the compositor sent since the last call and acks its configure. Listeners only
+    // record events, as with an event thread they run alongside the renderer.
+    void update();
+
     wl_surface *surface() noexcept;
 
 public:
     static constexpr uint32_t DEFAULT_SCALE_DPI = 120;
 
 private:
+    // Double buffered until xdg_surface.configure, apart from close and the decoration mode
+    struct PendingState {
+        std::optional<uint32_t> configure_serial;
+        std::optional<int32_t> integer_scale;
+        std::optional<uint32_t> fractional_scale;
+        std::optional<std::pair<int32_t, int32_t>> surface_bounds;
+        std::optional<std::pair<int32_t, int32_t>> surface_size;
+        bool fullscreen, maximized, suspended;
+        bool closed;
+        std::optional<uint32_t> decoration_mode;
+    };
+
     void toggle_fullscreen() noexcept;
 
 private:
@@ -46,6 +83,8 @@ private:
     WaylandPointer<wl_surface> _surface;
     WaylandPointer<xdg_surface> _wm_surface;
     WaylandPointer<xdg_toplevel> _toplevel;
+    std::optional<FrameScheduler> _frame_scheduler;
+    std::optional<PresentationFeedback> _presentation_feedback;
 
     // Optional protocols
     WaylandPointer<wp_content_type_v1> _content_type;
@@ -53,15 +92,19 @@ private:
     WaylandPointer<wp_viewport> _viewport;
     WaylandPointer<zxdg_toplevel_decoration_v1> _toplevel_decoration;
 
-    bool _closed, _fullscreen, _maximized, _has_server_decorations;
+    // Guards _pending, which listeners write and update() consumes
+    std::mutex _mutex;
+    PendingState _pending;
+
+    // Applied state, only touched by the thread that renders
+    bool _configured, _closed, _fullscreen, _maximized, _has_server_decorations;
+    bool _redraw_requested, _continuous_rendering, _suspended;
+    PresentPolicy _present_policy;
+    PointerConstraint _pointer_constraint;
     int32_t _actual_integer_scale;
-    std::optional<int32_t> _desired_integer_scale;
     uint32_t _actual_fractional_scale;
-    std::optional<uint32_t> _desired_fractional_scale;
 
     std::pair<int32_t, int32_t> _actual_surface_bounds;
-    std::optional<std::pair<int32_t, int32_t>> _desired_surface_bounds;
 
     std::pair<int32_t, int32_t> _actual_surface_size;
-    std::optional<std::pair<int32_t, int32_t>> _desired_surface_size;
 };